@@ -0,0 +1,107 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <json.hpp>
+
+#include "fanspeedcontrol/config/ConfigLoader.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "patterns/clock/ManualClock.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+namespace bench {
+
+// a multi device configuration with simulated devices, every curve has curvePoints temperatures
+std::string createConfiguration(int deviceCount, int curvePoints) {
+	nlohmann::json devices = nlohmann::json::array();
+	for (int i = 0; i < deviceCount; ++i) {
+		nlohmann::json device;
+		device["type"] = "simulated";
+		device["id"] = i;
+		device["minInterval"] = 250;
+		device["maxInterval"] = 2000;
+		device["interpolation"] = "cubic";
+		for (int point = 0; point < curvePoints; ++point) {
+			device[std::to_string(20 + point * 70 / curvePoints)] = point * 100 / curvePoints;
+		}
+		device["90"] = 100;
+		devices.push_back(device);
+	}
+
+	nlohmann::json configuration;
+	configuration["defaultHysteresis"] = 3;
+	configuration["devices"] = devices;
+	return configuration.dump();
+}
+
+// numbers of devices with a coarse and a fine-grained curve
+void applyConfigurationSizes(benchmark::internal::Benchmark *benchmark) {
+	for (int deviceCount : {1, 8, 64, 512, 4096}) {
+		for (int curvePoints : {7, 70}) {
+			benchmark->Args({deviceCount, curvePoints});
+		}
+	}
+}
+
+// startup and reload: the file is read and parsed and the devices are created
+void BM_LoadDevices(benchmark::State &state) {
+	const std::string path = "fanspeedcontrol_bench_" + std::to_string(state.range(0)) + ".json";
+	std::ofstream(path) << createConfiguration(state.range(0), state.range(1));
+	std::shared_ptr<msc42::patterns::ManualClock> clock = std::make_shared<msc42::patterns::ManualClock>();
+
+	for (auto _ : state) {
+		std::vector<std::string> errors;
+		std::vector<std::unique_ptr<AbstractDevice>> devices = loadDevices(path, 500, clock, errors);
+		if (devices.size() != static_cast<std::size_t>(state.range(0))) {
+			state.SkipWithError("the configuration is not valid");
+			break;
+		}
+	}
+
+	std::remove(path.c_str());
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadDevices)->Apply(applyConfigurationSizes)->Unit(benchmark::kMicrosecond);
+
+// only the parser and the checks, without the file and the devices
+void BM_ParseConfiguration(benchmark::State &state) {
+	const std::string text = createConfiguration(state.range(0), state.range(1));
+
+	for (auto _ : state) {
+		FileConfiguration configuration;
+		std::vector<std::string> errors;
+		if (!parseConfiguration(text, 500, configuration, errors)) {
+			state.SkipWithError("the configuration is not valid");
+			break;
+		}
+		benchmark::DoNotOptimize(configuration);
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseConfiguration)->Apply(applyConfigurationSizes)->Unit(benchmark::kMicrosecond);
+
+}
+}
+}
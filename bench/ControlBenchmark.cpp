@@ -0,0 +1,101 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "SimulatedDevices.h"
+#include "fanspeedcontrol/control/ControlServer.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/metrics/Metrics.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+namespace bench {
+
+const std::string CONTROL_SOCKET_PATH = "/tmp/fanspeedcontrol_bench_control.sock";
+
+// the status of all devices as the fleet agent requests it, without the socket
+void BM_ControlStatus(benchmark::State &state) {
+	std::vector<std::unique_ptr<AbstractDevice>> devices = createSimulatedDevices(state.range(0));
+	std::shared_ptr<Metrics> metrics = std::make_shared<Metrics>(devices);
+
+	std::unique_ptr<ControlServer> server = ControlServer::createUnixSocketServer(CONTROL_SOCKET_PATH, devices, metrics);
+	if (!server) {
+		state.SkipWithError("cannot create the control socket");
+		return;
+	}
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(server->answer("status"));
+	}
+}
+BENCHMARK(BM_ControlStatus)->RangeMultiplier(8)->Range(1, 512);
+
+// request and answer of the status over a connection, which is kept open like by a polling client
+void BM_ControlStatusRoundTrip(benchmark::State &state) {
+	std::vector<std::unique_ptr<AbstractDevice>> devices = createSimulatedDevices(state.range(0));
+	std::shared_ptr<Metrics> metrics = std::make_shared<Metrics>(devices);
+
+	std::unique_ptr<ControlServer> server = ControlServer::createUnixSocketServer(CONTROL_SOCKET_PATH, devices, metrics);
+	if (!server) {
+		state.SkipWithError("cannot create the control socket");
+		return;
+	}
+
+	sockaddr_un address = sockaddr_un();
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, CONTROL_SOCKET_PATH.c_str(), sizeof(address.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+		state.SkipWithError("cannot connect to the control socket");
+		return;
+	}
+
+	const std::string request = "status\n";
+	std::string answer;
+	char buffer[65536];
+
+	for (auto _ : state) {
+		send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+
+		answer.clear();
+		while (answer.empty() || answer.back() != '\n') {
+			ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+			if (received <= 0) {
+				state.SkipWithError("connection closed");
+				break;
+			}
+			answer.append(buffer, received);
+		}
+	}
+
+	close(fd);
+}
+BENCHMARK(BM_ControlStatusRoundTrip)->RangeMultiplier(8)->Range(1, 512);
+
+}
+}
+}
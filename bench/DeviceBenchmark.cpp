@@ -0,0 +1,417 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "AllocationCounter.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/devices/HwmonDevice.h"
+#include "fanspeedcontrol/devices/InvalidAttribute.h"
+#include "fanspeedcontrol/devices/NvmlGpu.h"
+#include "fanspeedcontrol/devices/SimulatedDevice.h"
+#include "patterns/clock/ManualClock.h"
+#include "patterns/observer/AbstractObserver.h"
+#include "patterns/observer/AsyncObserver.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+namespace bench {
+
+const std::chrono::milliseconds TICK_INTERVAL(500);
+
+// simulated device, which makes the protected fan speed lookups accessible
+class BenchmarkDevice: public SimulatedDevice {
+public:
+	BenchmarkDevice(int id, const std::map<int, int> &pairs, double noise, int hysteresis = 2)
+	: SimulatedDevice(id, hysteresis, 100, pairs, 25, 1, 0.05, noise, id) {
+	}
+
+	// the hysteresis is used only below the current fan speed
+	void setCurrentFanSpeed(int fanSpeed) {
+		currentFanSpeed = fanSpeed;
+	}
+
+	using AbstractDevice::calculateOptimalFanSpeed;
+	using AbstractDevice::getFanSpeed;
+};
+
+// curve with size temperatures between 20 and 100 celsius and rising fan speeds
+std::map<int, int> createCurve(int size) {
+	std::map<int, int> pairs;
+	for (int i = 0; i < size; ++i) {
+		int temperature = size == 1 ? 60 : 20 + i * 80 / (size - 1);
+		pairs[temperature] = size == 1 ? MAX_FAN_SPEED : i * MAX_FAN_SPEED / (size - 1);
+	}
+	return pairs;
+}
+
+void BM_SetOptimalFanSpeed(benchmark::State &state) {
+	const int deviceCount = state.range(0);
+
+	std::shared_ptr<msc42::patterns::ManualClock> clock = std::make_shared<msc42::patterns::ManualClock>();
+	std::shared_ptr<msc42::patterns::AsyncObserver> asyncObserver = std::make_shared<msc42::patterns::AsyncObserver>(
+			std::vector<std::shared_ptr<msc42::patterns::AbstractObserver>>(), 1024);
+
+	std::vector<std::unique_ptr<AbstractDevice>> devices;
+	for (int i = 0; i < deviceCount; ++i) {
+		// noise changes the fan speed from time to time, so that writes and events are part of the measurement
+		devices.emplace_back(new BenchmarkDevice(i, createCurve(8), 1));
+		devices.back()->setClock(clock);
+		devices.back()->setIndex(i);
+		devices.back()->registerObserver(asyncObserver);
+	}
+
+	// the first tick sets the manual mode and adapts the devices to their parameters, it is not the steady state
+	for (const std::unique_ptr<AbstractDevice> &device : devices) {
+		device->setOptimalFanSpeed();
+	}
+	clock->advance(TICK_INTERVAL);
+
+	unsigned long allocations = getAllocationCount();
+
+	for (auto _ : state) {
+		for (const std::unique_ptr<AbstractDevice> &device : devices) {
+			device->setOptimalFanSpeed();
+		}
+		clock->advance(TICK_INTERVAL);
+	}
+
+	allocations = getAllocationCount() - allocations;
+
+	state.SetItemsProcessed(state.iterations() * deviceCount);
+	state.counters["allocationsPerTick"] = benchmark::Counter(
+			static_cast<double>(allocations) / deviceCount, benchmark::Counter::kAvgIterations);
+
+	// the control of the devices and the queued events must not allocate, the run fails otherwise
+	if (allocations > 0) {
+		state.SkipWithError("the steady state of the control allocates memory");
+	}
+}
+BENCHMARK(BM_SetOptimalFanSpeed)->RangeMultiplier(4)->Range(1, 1024);
+
+void BM_CalculateOptimalFanSpeed(benchmark::State &state) {
+	BenchmarkDevice device(0, createCurve(state.range(0)), 0);
+	device.setInterpolation(static_cast<AbstractDevice::Interpolation>(state.range(1)));
+	AbstractDevice::Parameters parameters = device.getParameters();
+
+	int temperature = MIN_TEMPERATURE_VALID;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(device.calculateOptimalFanSpeed(parameters, temperature));
+		temperature = temperature < MAX_TEMPERATURE_VALID ? temperature + 1 : MIN_TEMPERATURE_VALID;
+	}
+}
+BENCHMARK(BM_CalculateOptimalFanSpeed)->ArgsProduct({{2, 8, 32, 128},
+		{AbstractDevice::INTERPOLATION_STEP, AbstractDevice::INTERPOLATION_MONOTONE_CUBIC}});
+
+// the walk through the curve, which is used without compiled fan speed tables
+void BM_GetFanSpeed(benchmark::State &state) {
+	BenchmarkDevice device(0, createCurve(state.range(0)), 0);
+	AbstractDevice::Parameters parameters = device.getParameters();
+
+	int temperature = MIN_TEMPERATURE_VALID;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(BenchmarkDevice::getFanSpeed(parameters, temperature, 2));
+		temperature = temperature < MAX_TEMPERATURE_VALID ? temperature + 1 : MIN_TEMPERATURE_VALID;
+	}
+}
+BENCHMARK(BM_GetFanSpeed)->RangeMultiplier(4)->Range(2, 128);
+
+// the walk through the pairs and the choice of the hysteresis as they were before the fan speed tables,
+// kept here unchanged as the reference for the tables
+int getReferenceFanSpeed(const std::map<int, int> &pairs, int hysteresis, int currentFanSpeed,
+		int currentTemperature) {
+	auto getFanSpeed = [&pairs](int temperature, int shift) {
+		for (const std::pair<const int, int> &kv : pairs) {
+			if (temperature < kv.first - shift) {
+				return kv.second;
+			}
+		}
+		return 100;
+	};
+
+	int optimalFanSpeedWithoutHysteresis = getFanSpeed(currentTemperature, 0);
+
+	if (optimalFanSpeedWithoutHysteresis < currentFanSpeed) {
+		return getFanSpeed(currentTemperature, hysteresis);
+	}
+
+	return optimalFanSpeedWithoutHysteresis;
+}
+
+// compares the lookup in the fan speed tables with the reference for every temperature (also outside the valid
+// range) and every current fan speed, the run fails at the first difference
+void BM_CompareFanSpeedTable(benchmark::State &state) {
+	const int hysteresis = state.range(0);
+
+	std::vector<std::map<int, int>> curves = {createCurve(1), createCurve(2), createCurve(8), createCurve(32),
+			{{MIN_TEMPERATURE_VALID, 0}, {MIN_TEMPERATURE_VALID + 1, 50}, {MAX_TEMPERATURE_VALID, 60}},
+			{{40, 30}, {41, 30}, {42, 30}, {70, 100}}};
+
+	std::vector<std::unique_ptr<BenchmarkDevice>> devices;
+	for (const std::map<int, int> &curve : curves) {
+		devices.emplace_back(new BenchmarkDevice(0, curve, 0, hysteresis));
+	}
+
+	// the interpolated curves have no reference, their hysteresis must hold the fan speed between the fan speed
+	// of the curve and the current one, so that the fan speed never rises on a falling temperature
+	curves.push_back({{40, 25}, {60, 40}, {75, 60}});
+	std::vector<std::unique_ptr<BenchmarkDevice>> interpolatedDevices;
+	for (const std::map<int, int> &curve : curves) {
+		for (AbstractDevice::Interpolation interpolation :
+				{AbstractDevice::INTERPOLATION_LINEAR, AbstractDevice::INTERPOLATION_MONOTONE_CUBIC}) {
+			interpolatedDevices.emplace_back(new BenchmarkDevice(0, curve, 0, hysteresis));
+			interpolatedDevices.back()->setInterpolation(interpolation);
+		}
+	}
+
+	for (auto _ : state) {
+		for (std::size_t i = 0; i < devices.size(); ++i) {
+			AbstractDevice::Parameters parameters = devices[i]->getParameters();
+
+			for (int temperature = MIN_TEMPERATURE_VALID - 10; temperature <= MAX_TEMPERATURE_VALID + 10;
+					++temperature) {
+				for (int currentFanSpeed = -1; currentFanSpeed <= MAX_FAN_SPEED; ++currentFanSpeed) {
+					devices[i]->setCurrentFanSpeed(currentFanSpeed);
+
+					if (devices[i]->calculateOptimalFanSpeed(parameters, temperature)
+							!= getReferenceFanSpeed(curves[i], hysteresis, currentFanSpeed, temperature)) {
+						state.SkipWithError(("the fan speed table of curve " + std::to_string(i)
+								+ " differs at the temperature " + std::to_string(temperature)
+								+ " and the current fan speed " + std::to_string(currentFanSpeed)).c_str());
+						return;
+					}
+				}
+			}
+		}
+
+		for (std::size_t i = 0; i < interpolatedDevices.size(); ++i) {
+			BenchmarkDevice &device = *interpolatedDevices[i];
+			AbstractDevice::Parameters parameters = device.getParameters();
+
+			for (int temperature = MIN_TEMPERATURE_VALID - 10; temperature <= MAX_TEMPERATURE_VALID + 10;
+					++temperature) {
+				device.setCurrentFanSpeed(-1);
+				const int curveFanSpeed = device.calculateOptimalFanSpeed(parameters, temperature);
+
+				for (int currentFanSpeed = -1; currentFanSpeed <= MAX_FAN_SPEED; ++currentFanSpeed) {
+					device.setCurrentFanSpeed(currentFanSpeed);
+					const int fanSpeed = device.calculateOptimalFanSpeed(parameters, temperature);
+
+					if (curveFanSpeed < currentFanSpeed ? fanSpeed < curveFanSpeed || fanSpeed > currentFanSpeed
+							: fanSpeed != curveFanSpeed) {
+						state.SkipWithError(("the hysteresis of the interpolated curve " + std::to_string(i / 2)
+								+ " is not held at the temperature " + std::to_string(temperature)
+								+ " and the current fan speed " + std::to_string(currentFanSpeed)).c_str());
+						return;
+					}
+				}
+			}
+
+			// a falling temperature from the maximum, every fan speed is the current one of the next degree
+			device.setCurrentFanSpeed(-1);
+			for (int temperature = MAX_TEMPERATURE_VALID; temperature >= MIN_TEMPERATURE_VALID; --temperature) {
+				const int currentFanSpeed = device.getCurrentFanSpeed();
+				const int fanSpeed = device.calculateOptimalFanSpeed(parameters, temperature);
+
+				if (currentFanSpeed >= 0 && fanSpeed > currentFanSpeed) {
+					state.SkipWithError(("the fan speed of the interpolated curve " + std::to_string(i / 2)
+							+ " rises on the falling temperature " + std::to_string(temperature)).c_str());
+					return;
+				}
+				device.setCurrentFanSpeed(fanSpeed);
+			}
+		}
+	}
+}
+BENCHMARK(BM_CompareFanSpeedTable)->Arg(0)->Arg(2)->Arg(60);
+
+// hwmon directory with a temperature input and a fan in a temporary directory, the files are regular files,
+// so that the device reads and writes them like the attribute files of sysfs
+class FakeHwmonTree {
+public:
+	FakeHwmonTree() {
+		char pattern[] = "/tmp/fanspeedcontrol_bench_XXXXXX";
+		if (mkdtemp(pattern)) {
+			root = pattern;
+		}
+		for (const char *name : {"temp1_input", "pwm1", "pwm1_enable"}) {
+			write(name, "0\n");
+		}
+	}
+
+	~FakeHwmonTree() {
+		for (const char *name : {"temp1_input", "pwm1", "pwm1_enable"}) {
+			unlink((root + "/" + name).c_str());
+		}
+		rmdir(root.c_str());
+	}
+
+	void write(const std::string &name, const std::string &text) const {
+		std::ofstream(root + "/" + name) << text;
+	}
+
+	int readInt(const std::string &name) const {
+		int value = -1;
+		std::ifstream(root + "/" + name) >> value;
+		return value;
+	}
+
+	std::string root;
+};
+
+// a tick of a hwmon device with a pread of the temperature, the checks fail the run if the manual mode,
+// a shorter fan speed after a longer one or the restore of the original mode are not written
+void BM_HwmonDevice(benchmark::State &state) {
+	// a mode of the driver, which is neither the manual mode nor the default automatic mode
+	const int originalPwmEnable = 5;
+
+	FakeHwmonTree tree;
+	tree.write("temp1_input", "90000\n");
+	tree.write("pwm1_enable", std::to_string(originalPwmEnable) + "\n");
+
+	std::shared_ptr<msc42::patterns::ManualClock> clock = std::make_shared<msc42::patterns::ManualClock>();
+
+	{
+		HwmonDevice device(0, 2, 100, createCurve(8), tree.root, "temp1_input", "pwm1");
+		device.setClock(clock);
+
+		device.setOptimalFanSpeed();
+		clock->advance(TICK_INTERVAL);
+		const int longPwm = tree.readInt("pwm1");
+
+		tree.write("temp1_input", "20000\n");
+		device.setOptimalFanSpeed();
+		clock->advance(TICK_INTERVAL);
+
+		// the value has fewer digits than 255, the rest of the longer value must not be read
+		const int expectedPwm = (device.getCurrentFanSpeed() * 255 + MAX_FAN_SPEED / 2) / MAX_FAN_SPEED;
+		if (tree.readInt("pwm1_enable") != 1 || longPwm != 255 || expectedPwm >= 100
+				|| tree.readInt("pwm1") != expectedPwm) {
+			state.SkipWithError("the hwmon device did not write the manual mode or the fan speeds");
+			return;
+		}
+
+		for (auto _ : state) {
+			device.setOptimalFanSpeed();
+			clock->advance(TICK_INTERVAL);
+		}
+	}
+
+	if (tree.readInt("pwm1_enable") != originalPwmEnable) {
+		state.SkipWithError("the hwmon device did not restore the original mode of the driver");
+	}
+}
+BENCHMARK(BM_HwmonDevice);
+
+// nvml device, which makes the protected load accessible
+class BenchmarkNvmlGpu: public NvmlGpu {
+public:
+	BenchmarkNvmlGpu(const std::map<int, int> &pairs, const std::string &libraryPath)
+	: NvmlGpu(0, 2, 100, pairs, libraryPath) {
+	}
+
+	using NvmlGpu::getLoad;
+};
+
+bool hasInvalidAttribute(const AbstractDevice &device, const std::string &attribute) {
+	InvalidAttributes invalidAttributes;
+	device.checkAttributes(invalidAttributes);
+	return std::any_of(invalidAttributes.begin(), invalidAttributes.end(),
+			[&attribute](const InvalidAttribute &invalidAttribute) {
+		return invalidAttribute.attribute == attribute;
+	});
+}
+
+// a tick of a nvml device with the stub of the library, the checks fail the run if the stub without the optional
+// functions of the load, the failed initialization, a missing library or the fan speeds are not handled
+void BM_NvmlGpu(benchmark::State &state) {
+	// the stub stays loaded, so that its fan speeds are kept after the devices unloaded it
+	void *stub = dlopen(NVML_STUB_PATH, RTLD_NOW | RTLD_LOCAL);
+	int (*getStubFanSpeed)(unsigned int) = stub ? reinterpret_cast<int (*)(unsigned int)>(
+			dlsym(stub, "nvmlStubGetFanSpeed")) : nullptr;
+	if (!getStubFanSpeed) {
+		state.SkipWithError("the stub of the nvidia management library cannot be loaded");
+		return;
+	}
+
+	{
+		BenchmarkNvmlGpu withoutLoad(createCurve(8), NVML_STUB_WITHOUT_LOAD_PATH);
+		BenchmarkNvmlGpu initFails(createCurve(8), NVML_STUB_INIT_FAILS_PATH);
+		BenchmarkNvmlGpu missing(createCurve(8), "/nonexistent/libnvidia-ml.so.1");
+
+		if (hasInvalidAttribute(withoutLoad, "nvmlLibrary") || withoutLoad.getLoad() != -1
+				|| !hasInvalidAttribute(initFails, "nvmlLibrary") || !hasInvalidAttribute(missing, "nvmlLibrary")) {
+			state.SkipWithError("the optional functions, the initialization or the loading of the library "
+					"are not handled");
+			dlclose(stub);
+			return;
+		}
+	}
+
+	std::shared_ptr<msc42::patterns::ManualClock> clock = std::make_shared<msc42::patterns::ManualClock>();
+
+	{
+		BenchmarkNvmlGpu gpu(createCurve(8), NVML_STUB_PATH);
+		gpu.setClock(clock);
+
+		gpu.setOptimalFanSpeed();
+		clock->advance(TICK_INTERVAL);
+
+		if (hasInvalidAttribute(gpu, "nvmlLibrary") || hasInvalidAttribute(gpu, "id") || gpu.getLoad() != 75
+				|| getStubFanSpeed(0) != gpu.getCurrentFanSpeed() || getStubFanSpeed(1) != gpu.getCurrentFanSpeed()) {
+			state.SkipWithError("the nvml device did not read the load or did not set the fan speeds");
+			dlclose(stub);
+			return;
+		}
+
+		for (auto _ : state) {
+			gpu.setOptimalFanSpeed();
+			clock->advance(TICK_INTERVAL);
+		}
+	}
+
+	if (getStubFanSpeed(0) != -1 || getStubFanSpeed(1) != -1) {
+		state.SkipWithError("the nvml device did not restore the default fan speeds");
+	}
+	dlclose(stub);
+}
+BENCHMARK(BM_NvmlGpu);
+
+void BM_DeviceToString(benchmark::State &state) {
+	BenchmarkDevice device(0, createCurve(8), 0);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(device.to_string(state.range(0)));
+	}
+}
+BENCHMARK(BM_DeviceToString)->Arg(false)->Arg(true);
+
+}
+}
+}
@@ -0,0 +1,64 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "SimulatedDevices.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/metrics/History.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+namespace bench {
+
+const std::string HISTORY_PATH = "/tmp/fanspeedcontrol_bench_history";
+
+// a day of samples with the default polling interval
+const std::size_t HISTORY_BENCH_CAPACITY = 24 * 60 * 60 * 2;
+
+// the cost added to every control of a device
+void BM_HistoryRecord(benchmark::State &state) {
+	std::vector<std::unique_ptr<AbstractDevice>> devices = createSimulatedDevices(1);
+	devices[0]->setOptimalFanSpeed();
+
+	std::remove(HISTORY_PATH.c_str());
+	std::unique_ptr<History> history = History::open(HISTORY_PATH, devices, std::chrono::milliseconds(500),
+			HISTORY_BENCH_CAPACITY);
+	if (!history) {
+		state.SkipWithError("cannot open the history file");
+		return;
+	}
+
+	for (auto _ : state) {
+		history->record(0, *devices[0]);
+	}
+
+	history.reset();
+	std::remove(HISTORY_PATH.c_str());
+}
+BENCHMARK(BM_HistoryRecord);
+
+}
+}
+}
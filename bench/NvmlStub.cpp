@@ -0,0 +1,115 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+// stub of the nvidia management library with a single gpu with two fans, which is loaded with dlopen like the
+// real library, NVML_STUB_WITHOUT_LOAD leaves out the optional functions of the load and NVML_STUB_INIT_FAILS
+// lets the initialization fail
+
+namespace {
+
+const int NVML_SUCCESS = 0;
+const int NVML_ERROR_INVALID_ARGUMENT = 2;
+const int NVML_ERROR_DRIVER_NOT_LOADED = 9;
+
+const unsigned int FAN_COUNT = 2;
+const unsigned int TEMPERATURE = 70;
+
+// fan speed in percent, -1 for the default fan speed of the driver
+int fanSpeeds[FAN_COUNT] = {-1, -1};
+
+}
+
+extern "C" {
+
+typedef struct nvmlDevice_st *nvmlDevice_t;
+
+struct nvmlUtilization_t {
+	unsigned int gpu;
+	unsigned int memory;
+};
+
+int nvmlInit_v2() {
+#ifdef NVML_STUB_INIT_FAILS
+	return NVML_ERROR_DRIVER_NOT_LOADED;
+#else
+	return NVML_SUCCESS;
+#endif
+}
+
+int nvmlShutdown() {
+	return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetHandleByIndex_v2(unsigned int index, nvmlDevice_t *device) {
+	if (index > 0) {
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+	*device = reinterpret_cast<nvmlDevice_t>(fanSpeeds);
+	return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetTemperature(nvmlDevice_t, int, unsigned int *temperature) {
+	*temperature = TEMPERATURE;
+	return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetNumFans(nvmlDevice_t, unsigned int *fans) {
+	*fans = FAN_COUNT;
+	return NVML_SUCCESS;
+}
+
+int nvmlDeviceSetFanSpeed_v2(nvmlDevice_t, unsigned int fan, unsigned int speed) {
+	if (fan >= FAN_COUNT || speed > 100) {
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+	fanSpeeds[fan] = static_cast<int>(speed);
+	return NVML_SUCCESS;
+}
+
+int nvmlDeviceSetDefaultFanSpeed_v2(nvmlDevice_t, unsigned int fan) {
+	if (fan >= FAN_COUNT) {
+		return NVML_ERROR_INVALID_ARGUMENT;
+	}
+	fanSpeeds[fan] = -1;
+	return NVML_SUCCESS;
+}
+
+#ifndef NVML_STUB_WITHOUT_LOAD
+// the load is 75 percent, the maximum of the utilization and the power draw relative to the power limit
+int nvmlDeviceGetUtilizationRates(nvmlDevice_t, nvmlUtilization_t *utilization) {
+	utilization->gpu = 30;
+	utilization->memory = 10;
+	return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetPowerUsage(nvmlDevice_t, unsigned int *power) {
+	*power = 150000;
+	return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetEnforcedPowerLimit(nvmlDevice_t, unsigned int *powerLimit) {
+	*powerLimit = 200000;
+	return NVML_SUCCESS;
+}
+#endif
+
+// not part of the real library, the benchmark reads the fan speeds set by the device
+int nvmlStubGetFanSpeed(unsigned int fan) {
+	return fan < FAN_COUNT ? fanSpeeds[fan] : -1;
+}
+
+}
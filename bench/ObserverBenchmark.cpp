@@ -0,0 +1,122 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "patterns/observer/AbstractObserver.h"
+#include "patterns/observer/AsyncObserver.h"
+#include "patterns/observer/Event.h"
+#include "patterns/observer/Observable.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+namespace bench {
+
+// observer with the least possible work, so that only the cost of the notification is measured
+class CountingObserver: public msc42::patterns::AbstractObserver {
+public:
+	virtual bool notify(int messageId, const std::string &message1 = "", const std::string &message2 = "") {
+		count.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	virtual bool notify(const msc42::patterns::Event &event) {
+		count.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+private:
+	std::atomic<unsigned long> count{0};
+};
+
+msc42::patterns::Event createBenchmarkEvent() {
+	msc42::patterns::Event event = msc42::patterns::Event();
+	event.messageId = AbstractDevice::FAN_SET;
+	event.temperature = 60;
+	event.fanSpeed = 40;
+	event.timestamp = std::chrono::steady_clock::now();
+	return event;
+}
+
+void BM_NotifyObserversEvent(benchmark::State &state) {
+	msc42::patterns::Observable observable;
+	for (int i = 0; i < state.range(0); ++i) {
+		observable.registerObserver(std::make_shared<CountingObserver>());
+	}
+
+	msc42::patterns::Event event = createBenchmarkEvent();
+	for (auto _ : state) {
+		observable.notifyObservers(event);
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NotifyObserversEvent)->RangeMultiplier(4)->Range(1, 64);
+
+// the text notification, which is only used for rare messages, for comparison
+void BM_NotifyObserversString(benchmark::State &state) {
+	msc42::patterns::Observable observable;
+	for (int i = 0; i < state.range(0); ++i) {
+		observable.registerObserver(std::make_shared<CountingObserver>());
+	}
+
+	for (auto _ : state) {
+		observable.notifyObservers(AbstractDevice::FAN_SET, "{\"type\":\"simulated\", \"id\":0}", std::to_string(60));
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NotifyObserversString)->RangeMultiplier(4)->Range(1, 64);
+
+// cost for the control thread, the observers are called by the dispatcher thread,
+// which cannot keep up with this loop, so the counter dropped shows how many events were rejected by the full queue
+void BM_AsyncObserverNotify(benchmark::State &state) {
+	std::vector<std::shared_ptr<msc42::patterns::AbstractObserver>> observers;
+	for (int i = 0; i < state.range(0); ++i) {
+		observers.push_back(std::make_shared<CountingObserver>());
+	}
+	msc42::patterns::AsyncObserver asyncObserver(observers, 1024);
+
+	msc42::patterns::Event event = createBenchmarkEvent();
+	for (auto _ : state) {
+		asyncObserver.notify(event);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	state.counters["dropped"] = asyncObserver.getDroppedCount();
+}
+BENCHMARK(BM_AsyncObserverNotify)->Arg(1)->Arg(4);
+
+void BM_EventToString(benchmark::State &state) {
+	msc42::patterns::Event event = createBenchmarkEvent();
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(AbstractDevice::to_string(event));
+	}
+}
+BENCHMARK(BM_EventToString);
+
+}
+}
+}
@@ -0,0 +1,36 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SimulatedDevices.h"
+
+#include "fanspeedcontrol/devices/SimulatedDevice.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+namespace bench {
+
+std::vector<std::unique_ptr<AbstractDevice>> createSimulatedDevices(int count) {
+	std::vector<std::unique_ptr<AbstractDevice>> devices;
+	for (int i = 0; i < count; ++i) {
+		devices.emplace_back(new SimulatedDevice(i, 2, 90, {{40, 20}, {60, 60}, {80, 100}}, 25, 1, 0.05, 0, i));
+	}
+	return devices;
+}
+
+}
+}
+}
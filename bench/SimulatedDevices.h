@@ -0,0 +1,37 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BENCH_SIMULATEDDEVICES_H_
+#define BENCH_SIMULATEDDEVICES_H_
+
+#include <memory>
+#include <vector>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+namespace bench {
+
+// count simulated devices with the same curve, which are not controlled yet, the id is the index
+std::vector<std::unique_ptr<AbstractDevice>> createSimulatedDevices(int count);
+
+}
+}
+}
+
+#endif /* BENCH_SIMULATEDDEVICES_H_ */
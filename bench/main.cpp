@@ -0,0 +1,103 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+
+namespace {
+
+std::atomic<unsigned long> allocationCount(0);
+
+void *allocate(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	void *memory = std::malloc(size == 0 ? 1 : size);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+}
+
+// every allocation of the program is counted, so that the benchmarks can report allocations per iteration
+void *operator new(std::size_t size) {
+	return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+	return allocate(size);
+}
+
+void operator delete(void *memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+namespace msc42 {
+namespace fanspeedcontrol {
+namespace bench {
+
+unsigned long getAllocationCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+}
+}
+}
+
+int main(int argc, char *argv[]) {
+	// the results are written as json unless another format is requested, so that they can be compared over time
+	std::vector<char *> arguments(argv, argv + argc);
+	std::string jsonFormat = "--benchmark_format=json";
+	if (std::none_of(arguments.begin(), arguments.end(), [](const char *argument) {
+		return std::strncmp(argument, "--benchmark_format", std::strlen("--benchmark_format")) == 0;
+	})) {
+		arguments.push_back(&jsonFormat[0]);
+	}
+
+	int argumentCount = arguments.size();
+	benchmark::Initialize(&argumentCount, arguments.data());
+	if (benchmark::ReportUnrecognizedArguments(argumentCount, arguments.data())) {
+		return EXIT_FAILURE;
+	}
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return EXIT_SUCCESS;
+}
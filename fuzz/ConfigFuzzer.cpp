@@ -0,0 +1,41 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "fanspeedcontrol/config/ConfigLoader.h"
+
+// only the parsing is fuzzed, creating the devices would open the hardware
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+	msc42::fanspeedcontrol::FileConfiguration configuration;
+	std::vector<std::string> errors;
+
+	bool valid = msc42::fanspeedcontrol::parseConfiguration(std::string(reinterpret_cast<const char *>(data), size),
+			500, configuration, errors);
+
+	// a configuration is valid exactly if no error was reported
+	if (valid != errors.empty() || (valid && configuration.devices.empty())) {
+		std::abort();
+	}
+
+	return 0;
+}
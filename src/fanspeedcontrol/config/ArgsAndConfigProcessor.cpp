@@ -19,28 +19,39 @@
 
 #include <array>
 #include <chrono>
+#include <cstddef>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
-#include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <utility>
 #include <variant>
 #include <vector>
 
-#include <boost/interprocess/sync/named_mutex.hpp>
+#include <boost/format.hpp>
 #include <boost/program_options.hpp>
 #include <json.hpp>
 #include <libintl.h>
+#include <X11/Xlib.h>
 
+#include "ConfigLoader.h"
+#include "fanspeedcontrol/control/ControlLoop.h"
+#include "fanspeedcontrol/control/Watchdog.h"
 #include "fanspeedcontrol/devices/AbstractDevice.h"
-#include "fanspeedcontrol/devices/NvidiaGpu.h"
+#include "fanspeedcontrol/metrics/History.h"
+#include "fanspeedcontrol/metrics/Metrics.h"
+#include "fanspeedcontrol/metrics/MetricsObserver.h"
+#include "fanspeedcontrol/metrics/MetricsServer.h"
 #include "fanspeedcontrol/observers/LoggerObserver.h"
 #include "fanspeedcontrol/observers/NotifyObserver.h"
 #include "fanspeedcontrol/observers/SoundObserver.h"
+#include "patterns/clock/Clock.h"
+#include "patterns/clock/ManualClock.h"
+#include "patterns/clock/ScaledClock.h"
+#include "patterns/clock/SteadyClock.h"
+#include "patterns/lock/PidFileLock.h"
 #include "patterns/observer/AbstractObserver.h"
+#include "patterns/observer/AsyncObserver.h"
 
 #ifndef CONFIG_FILE
 #define CONFIG_FILE "/usr/local/etc/fanspeedcontrol.json"
@@ -53,19 +64,8 @@
 namespace msc42 {
 namespace fanspeedcontrol {
 
-const int DEFAULT_WARN = 100;
-const int DEFAULT_HYSTERESIS = 0;
-
-const std::string TYPE_KEY = "type";
-const std::string ID_KEY = "id";
-const std::string DISPLAY_NAME_KEY = "displayName";
-const std::string HYSTERESIS_KEY = "hysteresis";
-const std::string WARN_KEY = "warn";
-const std::string DEVICES_ARRAY_KEY = "devices";
-const std::string DEFAULT_HYSTERESIS_KEY = "defaultHysteresis";
-const std::string DEFAULT_WARN_KEY = "defaultWarn";
-
-const std::string TYPE_NVIDIA = "nvidia";
+// notifications which do not fit into the queue of the observers are dropped
+const std::size_t OBSERVER_QUEUE_CAPACITY = 1024;
 
 const std::string argumentHelp("help");
 const std::string argumentsHelp = argumentHelp + ",h";
@@ -85,6 +85,8 @@ const std::string argumentsNotifyInterval = argumentNotifyInterval + ",n";
 const std::string argumentLogInterval("log-interval");
 const std::string argumentsLogInterval = argumentLogInterval + ",r";
 
+const std::string argumentMessageBurst("message-burst");
+
 const std::string argumentLogPath("log-path");
 const std::string argumentsLogPath = argumentLogPath + ",p";
 
@@ -100,7 +102,31 @@ const std::string argumentsSoundFile = argumentSoundFile + ",s";
 const std::string argumentBeginOverSound("begin-over-sound");
 const std::string argumentsBeginOverSound = argumentBeginOverSound + ",o";
 
-const std::string argumentRemoveLock("remove-lock");
+const std::string argumentParallel("parallel");
+const std::string argumentsParallel = argumentParallel + ",t";
+
+const std::string argumentPidFile("pid-file");
+
+const std::string argumentTimeFactor("time-factor");
+
+const std::string argumentMetricsSocket("metrics-socket");
+
+const std::string argumentMetricsPort("metrics-port");
+
+const std::string argumentControlSocket("control-socket");
+
+const std::string argumentWatchdog("watchdog");
+
+const std::string argumentHistory("history");
+
+const std::string argumentHistoryDays("history-days");
+
+const std::string argumentDumpHistory("dump-history");
+
+const std::string HISTORY_FORMAT_CSV = "csv";
+const std::string HISTORY_FORMAT_JSON = "json";
+
+const long MILLISECONDS_PER_DAY = 24L * 60 * 60 * 1000;
 
 nlohmann::json getExampleSingleDeviceConfig(int id = 0) {
 	nlohmann::json json;
@@ -109,6 +135,9 @@ nlohmann::json getExampleSingleDeviceConfig(int id = 0) {
 	json[DISPLAY_NAME_KEY] = ":1";
 	json[HYSTERESIS_KEY] = 5;
 	json[WARN_KEY] = 85;
+	json[MIN_INTERVAL_KEY] = 250;
+	json[MAX_INTERVAL_KEY] = 2000;
+	json[INTERPOLATION_KEY] = INTERPOLATION_STEP;
 	json["20"] = 0;
 	json["40"] = 25;
 	json["60"] = 40;
@@ -129,98 +158,6 @@ nlohmann::json getExampleMultiDeviceConfig() {
 	return json;
 }
 
-template <typename type> type getJsonOrDefault(
-		const nlohmann::json &json, const std::string &key, const type &defaultValue) {
-	nlohmann::json::const_iterator keyIterator = json.find(key);
-	if (keyIterator != json.end()) {
-		return keyIterator.value();
-	}
-	return defaultValue;
-}
-
-bool isKeyThere(const nlohmann::json &json, const std::string &key) {
-	if (json.find(key) != json.end()) {
-		return true;
-	}
-	return false;
-}
-
-std::unique_ptr<AbstractDevice> getDeviceOptional(
-		const nlohmann::json &deviceConfiguration, int defaultHysteresis, int defaultWarn) {
-	int hysteresis = getJsonOrDefault<int>(deviceConfiguration, HYSTERESIS_KEY, defaultHysteresis);
-	int warn = getJsonOrDefault<int>(deviceConfiguration, WARN_KEY, defaultWarn);
-
-	if (!isKeyThere(deviceConfiguration, TYPE_KEY) || !isKeyThere(deviceConfiguration, ID_KEY)) {
-		return std::unique_ptr<AbstractDevice>();
-	}
-
-	std::map<int, int> pairs;
-	for (auto it = deviceConfiguration.begin(); it != deviceConfiguration.end(); ++it) {
-		if (std::regex_match(it.key(), REGEX_IS_INTEGER)) {
-			pairs[std::stoi(it.key())] = it.value();
-		}
-	}
-
-	nlohmann::json::const_iterator idIterator = deviceConfiguration.find(ID_KEY);
-	if (idIterator == deviceConfiguration.end()) {
-		return std::unique_ptr<AbstractDevice>();
-	}
-
-	int id = idIterator.value();
-
-	std::string type = deviceConfiguration.find(TYPE_KEY).value();
-	if (type == TYPE_NVIDIA) {
-		nlohmann::json::const_iterator displayNameIterator = deviceConfiguration.find(DISPLAY_NAME_KEY);
-		if (displayNameIterator == deviceConfiguration.end()) {
-			return std::unique_ptr<AbstractDevice>();
-		}
-		std::string displayName = displayNameIterator.value();
-		return std::unique_ptr<AbstractDevice>(new NvidiaGpu(id, hysteresis, warn, pairs, displayName));
-	} else {
-		return std::unique_ptr<AbstractDevice>();
-	}
-
-	return std::unique_ptr<AbstractDevice>();
-}
-
-std::vector<std::unique_ptr<AbstractDevice>> getDevicesOptional(const std::string &file) {
-	std::ifstream fileStream(file);
-	nlohmann::json json;
-
-	try {
-		fileStream >> json;
-	} catch(nlohmann::json::parse_error &e) {
-		return std::vector<std::unique_ptr<AbstractDevice>>();
-	}
-
-	int defaultHysteresis = getJsonOrDefault<int>(json, DEFAULT_HYSTERESIS_KEY, DEFAULT_HYSTERESIS);
-	int defaultWarn = getJsonOrDefault<int>(json, DEFAULT_WARN_KEY, DEFAULT_WARN);
-
-	std::vector<std::unique_ptr<AbstractDevice>> devices;
-	if (isKeyThere(json, DEVICES_ARRAY_KEY)) {
-		nlohmann::json deviceArray = json[DEVICES_ARRAY_KEY];
-
-		for (const nlohmann::json& jsonDevice : deviceArray) {
-			std::unique_ptr<AbstractDevice> device = getDeviceOptional(jsonDevice, defaultHysteresis, defaultWarn);
-			if (device) {
-				devices.push_back(std::move(device));
-			} else {
-				return std::vector<std::unique_ptr<AbstractDevice>>();
-			}
-		}
-
-	} else {
-		std::unique_ptr<AbstractDevice> device = getDeviceOptional(json, defaultHysteresis, defaultWarn);
-		if (device) {
-			devices.push_back(std::move(device));
-		} else {
-			return std::vector<std::unique_ptr<AbstractDevice>>();
-		}
-	}
-
-	return devices;
-}
-
 void setLocale() {
 	setlocale(LC_ALL, "");
 	bindtextdomain(APP_NAME.c_str(), LOCALE_DIR);
@@ -246,7 +183,8 @@ boost::program_options::options_description generateOptionDescription() {
 			gettext("location of the configuration file"))
 
 		(argumentsInterval.c_str(), boost::program_options::value<int>()->value_name(gettext("INTERVAL"))
-			->default_value(500), gettext("polling interval in milliseconds"))
+			->default_value(500), gettext("polling interval in milliseconds, "
+			"default of the minimal and maximal polling interval of the devices"))
 
 		(argumentsNotifyInterval.c_str(), boost::program_options::value<int>()
 				->value_name(gettext("INTERVAL"))->default_value(60),
@@ -256,6 +194,11 @@ boost::program_options::options_description generateOptionDescription() {
 			->default_value(60),
 			gettext("minimal interval to log repeatedly already occurred error messages in seconds"))
 
+		(argumentMessageBurst.c_str(), boost::program_options::value<unsigned int>()->value_name(gettext("NUMBER"))
+			->default_value(1),
+			gettext("number of repeated error messages of a device, which are logged and notified "
+					"before the log and notify intervals are applied"))
+
 		(argumentsLogPath.c_str(), boost::program_options::value<std::string>()->value_name(gettext("PATH"))
 				->default_value(""), gettext("path of an optional log file"))
 
@@ -273,10 +216,45 @@ boost::program_options::options_description generateOptionDescription() {
 				->default_value(300),
 			gettext("minimal interval to begin over playing the sound file with the application ffplay in seconds"))
 
-		(argumentRemoveLock.c_str(),
-			gettext("option for experts, remove the lock, use the option only if the lock is set, "
-			"but no other fanspeedcontrol instance is running, in doubt restart your machine "
-			"rather than remove lock, wrong usage of this option can overheat your system"));
+		(argumentsParallel.c_str(),
+			gettext("control every device in its own thread, so that a slow device does not delay the other devices"))
+
+		(argumentTimeFactor.c_str(), boost::program_options::value<double>()->value_name(gettext("FACTOR"))
+			->default_value(1),
+			gettext("option for tests with simulated devices, the time runs FACTOR times faster than the real time, "
+					"0 runs the time as fast as possible without waiting (not with the option parallel)"))
+
+		(argumentMetricsSocket.c_str(), boost::program_options::value<std::string>()->value_name(gettext("PATH")),
+			gettext("serve metrics in the prometheus text format over http on a unix socket with this path"))
+
+		(argumentMetricsPort.c_str(), boost::program_options::value<int>()->value_name(gettext("PORT")),
+			gettext("serve metrics in the prometheus text format over http on this port of the loopback address, "
+					"used instead of the option metrics-socket"))
+
+		(argumentControlSocket.c_str(), boost::program_options::value<std::string>()->value_name(gettext("PATH")),
+			gettext("accept status requests and commands (pin a fan speed or the automatic mode for some seconds, "
+					"change the polling intervals) on a unix socket with this path, only accessible by the user"))
+
+		(argumentWatchdog.c_str(), boost::program_options::value<int>()->value_name(gettext("SECONDS")),
+			gettext("start a watchdog process, which sets the devices to automatic mode or, if this is not possible, "
+					"to the maximal fan speed, if this instance terminates without stopping the devices (e.g. killed or "
+					"crashed) or a control of a device hangs for SECONDS seconds (then this instance is killed)"))
+
+		(argumentHistory.c_str(), boost::program_options::value<std::string>()->value_name(gettext("FILE")),
+			gettext("record the temperature, the fan speed and the mode of every device once per polling interval of "
+					"the option interval into this file, which keeps the samples of the last days also after a restart"))
+
+		(argumentHistoryDays.c_str(), boost::program_options::value<int>()->value_name(gettext("DAYS"))
+				->default_value(7), gettext("number of days the history file keeps"))
+
+		(argumentDumpHistory.c_str(), boost::program_options::value<std::string>()->value_name(gettext("FORMAT")),
+			gettext("print the history file of the option history in the format csv or json and exit, "
+					"also while another instance records it"))
+
+		(argumentPidFile.c_str(), boost::program_options::value<std::string>()->value_name(gettext("FILE"))
+				->default_value(DEFAULT_PID_FILE),
+			gettext("file with the process id of the running instance, only one instance can lock it, "
+					"the lock is released when the instance terminates, also if it is killed or crashes"));
 
 	return optionDescription;
 }
@@ -285,38 +263,57 @@ void printOnCoutConfigurationFormat() {
 	std::cout << gettext(
 				"The configuration file must be in the JSON format and has the following structure for a single "
 				"device configuration:\n"
-				"required attributes: type (value: \"nvidia\" (support must be activated in the Nvidia driver configuration)), id (value: <id of the device as integer>), "
-				"displayName (value: <display name of x server connected to the device as string>)\n"
+				"required attributes: type (value: \"nvidia\" (support must be activated in the Nvidia driver configuration), \"nvml\" (Nvidia gpu controlled by the Nvidia management library, no x server needed), \"hwmon\" (fan of the linux hwmon sysfs interface) or \"simulated\"), id (value: <id of the device as integer>)\n"
+				"required attributes of type nvidia: displayName (value: <display name of x server connected to the device as string>)\n"
+				"required attributes of type hwmon: temperatureInput (value: <temperature file relative to sysfsRoot as string, e.g. \"hwmon0/temp1_input\">), "
+				"pwm (value: <pwm file relative to sysfsRoot as string, e.g. \"hwmon0/pwm1\">)\n"
+				"optional attributes of type nvml: nvmlLibrary (value: <file of the Nvidia management library as string, default \"libnvidia-ml.so.1\">)\n"
+				"optional attributes of type hwmon: sysfsRoot (value: <root directory of the hwmon devices as string, default \"/sys/class/hwmon\">)\n"
+				"optional attributes of type simulated (device without hardware for tests): ambient (value: <ambient temperature in celsius as number, default 25>), "
+				"heatInput (value: <temperature rise in celsius per second as number, default 1>), cooling (value: <cooling per second at full fan speed "
+				"relative to the difference to the ambient temperature as number, default 0.05>), noise (value: <standard deviation of the "
+				"temperature readings in celsius as number, default 0>), seed (value: <seed of the noise as integer, default the id>), "
+				"load (value: <load in percent as integer, heatInput is reached at 100, default 100>), loadPeriod (value: <if "
+				"not 0, the load alternates between 0 and load every loadPeriod seconds starting with 0 as number, default 0>)\n"
 				"optional attributes: hysteresis (value: <hysteresis in celsius as integer>, warn (value: <warn temperature in celsius "
-				"as integer>), "
+				"as integer>), minInterval (value: <minimal polling interval in milliseconds as integer, approached by "
+				"halving the interval if the temperature rises or is near a temperature of the curve>), maxInterval (value: <maximal polling interval "
+				"in milliseconds as integer, reached step by step if the temperature is stable>), interpolation (value: "
+				"<\"step\" (default), \"linear\" or \"cubic\" (monotone cubic) interpolation between the temperatures of the "
+				"curve as string>), writeMinDelta (value: <minimal change of the fan speed in percent as integer, which is "
+				"written, default 0>), writeMinDwell (value: <minimal time in milliseconds as integer between a fan speed "
+				"write and a following decrease, default 0>), sensors (value: <array with names of sensors of the multi device configuration as strings, "
+				"the temperature is aggregated from these sensors instead of read from the device>), aggregation (value: "
+				"<\"max\" (default), \"mean\", \"weighted\" or \"ewma\" (exponentially weighted moving average of the maximum) "
+				"as string>), weights (value: <array with a weight for every sensor for the aggregation weighted as numbers>), "
+				"alpha (value: <smoothing factor between 0 and 1 for the aggregation ewma as number>), "
+				"controller (value: <\"curve\" (default) or \"pid\" (the fan speed is controlled to the target temperature, "
+				"the curve is used at the start, after invalid temperatures and as minimum from the warn temperature on) as string>), "
+				"target (value: <target temperature in celsius as number, required for the controller pid>), "
+				"kp, ki, kd (value: <proportional, integral and derivative gain of the controller pid in percent per celsius "
+				"as numbers, default 5, 0.1 and 0>), minSpeed, maxSpeed (value: <fan speed limits of the controller pid in "
+				"percent as numbers, default 0 and 100>), derivativeFilter (value: <time constant of the derivative filter "
+				"of the controller pid in seconds as number, default 1>), "
+				"feedForward (value: <fan speed in percent added per percent of load (nvidia: gpu utilization, nvml: maximum of gpu utilization and power draw relative to the power limit) above the "
+				"average load, so that the fan speed rises before the temperature, as number>), feedForwardTime (value: "
+				"<time in seconds over which the load is averaged, about the delay of the temperature, as number, default 10>), "
 				"arbitrary number of attributes <temperature in celsius as integer> (value: <fan speed in percent as integer>) \n"
 				"\n"
 				"example single device JSON file:\n")
 				<< getExampleSingleDeviceConfig().dump(4) << "\n\n" << gettext(
 				"The following structure is for a multi device configuration:\n"
 				"required attributes: deviceArray (value: array with JSON objects described for the single device configuration)\n"
-				"optional attributes: defaultHysteresis (value: <default hysteresis in celsius as integer>), defaultWarn (value: <default warn temperature in celsius as integer>)\n"
+				"optional attributes: defaultHysteresis (value: <default hysteresis in celsius as integer>), defaultWarn (value: <default warn temperature in celsius as integer>), "
+				"fans (value: <array with JSON objects like deviceArray, intended for devices which use sensors>), "
+				"sensors (value: <array with JSON objects of sensors, which are read once and shared by all fans using them, "
+				"required attributes: name (value: <unique name of the sensor as string>), type (value: <\"nvidia\" or \"hwmon\" as string>) "
+				"and the attributes to read the temperature of the device type>), "
+				"sensorMaxAge (value: <time in milliseconds as integer during which a sensor reading is shared, default half of the polling interval>)\n"
 				"\n"
 				"example multi device JSON file:\n")
-				<< getExampleMultiDeviceConfig().dump(4) << std::endl;
-}
-
-bool removeLockAfterPositiveDialog() {
-	std::cout << gettext("Are you sure to remove the lock?\n"
-				"This is an option for experts. Wrong usage of the option remove-lock can overheat your system. "
-				"See --help for more information.\n"
-				"Type y or yes to remove the lock,  n or no to not remove the lock and then enter.\n");
-
-	char decision;
-	std::cin >> decision;
-
-	if (decision != std::string(gettext("yes")).at(0)) {
-		return false;
-	}
-
-	boost::interprocess::named_mutex::remove(DOMAIN_NAME.c_str());
-
-	return true;
+				<< getExampleMultiDeviceConfig().dump(4) << "\n\n" << gettext(
+				"Send SIGHUP to reload the configuration file without a restart, it is only applied if it is valid and "
+				"has the same devices in the same order with the same hardware attributes.") << std::endl;
 }
 
 std::variant<configuration, int> processArguments(int argc, char *argv[]) {
@@ -345,49 +342,200 @@ std::variant<configuration, int> processArguments(int argc, char *argv[]) {
 		return EXIT_SUCCESS;
 	}
 
-	if (vm.count(argumentRemoveLock)) {
-		if (!removeLockAfterPositiveDialog()) {
-			return EXIT_SUCCESS;
+	// the history is only read, so it is dumped without the lock
+	if (vm.count(argumentDumpHistory)) {
+		const std::string format = vm[argumentDumpHistory].as<std::string>();
+		if (!vm.count(argumentHistory) || (format != HISTORY_FORMAT_CSV && format != HISTORY_FORMAT_JSON)) {
+			std::cout << gettext("The command line parameters are not valid.\n"
+					"Please use the option --help to display valid command line parameters.") << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const std::string historyPath = vm[argumentHistory].as<std::string>();
+		if (!History::dump(historyPath, format == HISTORY_FORMAT_CSV ? History::FORMAT_CSV : History::FORMAT_JSON,
+				std::cout)) {
+			std::cout << boost::format(gettext("Cannot read the history file %s.")) % historyPath << std::endl;
+			return EXIT_FAILURE;
 		}
+		return EXIT_SUCCESS;
 	}
 
+	// the lock is taken before a device or a socket is opened, so that a second instance changes nothing
+	const std::string pidFile = vm[argumentPidFile].as<std::string>();
+	pid_t ownerPid;
+	std::unique_ptr<msc42::patterns::PidFileLock> lock = msc42::patterns::PidFileLock::tryLock(pidFile, ownerPid);
+
+	if (!lock) {
+		if (ownerPid > 0) {
+			std::cout << boost::format(gettext("Cannot start this fanspeedcontrol instance, because another "
+					"instance with the process id %d is running. Terminate the running instance to start a new "
+					"instance.")) % ownerPid << std::endl;
+		} else {
+			std::cout << boost::format(gettext("Cannot lock the file %s.")) % pidFile << std::endl;
+		}
+		return EXIT_FAILURE;
+	}
+
+	if (ownerPid > 0) {
+		std::cout << boost::format(gettext("The previous fanspeedcontrol instance with the process id %d "
+				"was terminated without stopping its devices.")) % ownerPid << std::endl;
+	}
+
+	// the configuration is parsed once before the fork, so that the watchdog process keeps the same devices,
+	// even if the file is changed later, the errors are reported after the logger is created
+	const int interval = vm[argumentInterval].as<int>();
+	FileConfiguration fileConfiguration;
+	std::vector<std::string> configurationErrors;
+	const bool isConfigurationRead = readConfiguration(vm[argumentConfigurationPath].as<std::string>(), interval,
+			fileConfiguration, configurationErrors);
+
+	// the watchdog process is forked before a device is opened or a thread is started, it opens its own devices
+	std::shared_ptr<Watchdog> watchdog;
+	if (vm.count(argumentWatchdog)) {
+		// the control threads write the heartbeats at least every MAX_SLEEP_TIME of the clock,
+		// which is stretched by a time factor below 1
+		const int watchdogTimeout = vm[argumentWatchdog].as<int>();
+		const double timeFactor = vm[argumentTimeFactor].as<double>();
+		if (watchdogTimeout <= 0
+				|| (timeFactor > 0 && MAX_SLEEP_TIME / timeFactor * 2 >= std::chrono::seconds(watchdogTimeout))) {
+			std::cout << gettext("The command line parameters are not valid.\n"
+					"Please use the option --help to display valid command line parameters.") << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// without a valid configuration no device is opened and the control process terminates below
+		if (isConfigurationRead) {
+			watchdog = Watchdog::start(fileConfiguration, std::chrono::seconds(watchdogTimeout),
+					std::vector<int>{lock->getFd()});
+		}
+
+		if (isConfigurationRead && !watchdog) {
+			std::cout << gettext("Cannot start the watchdog process.") << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const unsigned int messageBurst = vm[argumentMessageBurst].as<unsigned int>();
+
 	std::shared_ptr<LoggerObserver>	loggerObserver(new LoggerObserver(
-			std::chrono::milliseconds(std::chrono::seconds(vm[argumentLogInterval].as<int>())),
+			std::chrono::milliseconds(std::chrono::seconds(vm[argumentLogInterval].as<int>())), messageBurst,
 			vm[argumentLogLevel].as<std::string>(), APP_NAME, vm[argumentLogPath].as<std::string>()));
 
 	std::shared_ptr<NotifyObserver> notifyObserver(new NotifyObserver(
-			std::chrono::milliseconds(std::chrono::seconds(vm[argumentNotifyInterval].as<int>())), APP_NAME));
+			std::chrono::milliseconds(std::chrono::seconds(vm[argumentNotifyInterval].as<int>())), messageBurst,
+			APP_NAME));
 
 	std::shared_ptr<SoundObserver> soundObserver(new SoundObserver(vm.count(argumentBeep),
 			vm[argumentSoundFile].as<std::string>(),
 			std::chrono::milliseconds(std::chrono::seconds(vm[argumentBeginOverSound].as<int>()))));
 
-	std::vector<std::unique_ptr<AbstractDevice>> devices =
-			getDevicesOptional(vm[argumentConfigurationPath].as<std::string>());
+	const bool parallel = vm.count(argumentParallel);
+
+	// Xlib must be initialized for threads before the first connection to the x server is opened
+	if (parallel) {
+		XInitThreads();
+	}
+
+	const double timeFactor = vm[argumentTimeFactor].as<double>();
+	if (timeFactor < 0 || (timeFactor == 0 && parallel)) {
+		std::cout << gettext("The command line parameters are not valid.\n"
+				"Please use the option --help to display valid command line parameters.") << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::shared_ptr<msc42::patterns::Clock> clock;
+	if (timeFactor == 0) {
+		clock = std::make_shared<msc42::patterns::ManualClock>(std::chrono::steady_clock::now());
+	} else if (timeFactor != 1) {
+		clock = std::make_shared<msc42::patterns::ScaledClock>(timeFactor);
+	} else {
+		clock = std::make_shared<msc42::patterns::SteadyClock>();
+	}
+
+	std::vector<std::unique_ptr<AbstractDevice>> devices;
+	std::shared_ptr<SensorSnapshot> snapshot;
+	if (isConfigurationRead) {
+		devices = createDevices(fileConfiguration, clock, snapshot, configurationErrors);
+	}
 
 	if (devices.empty()) {
-		loggerObserver->notify(AbstractDevice::CONFIG_FILE_ERROR);
+		loggerObserver->notify(AbstractDevice::CONFIG_FILE_ERROR, joinErrors(configurationErrors));
 		return EXIT_FAILURE;
 	}
 
+	// the observers limit repeated messages per device in tables indexed by the position of the device
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		devices[i]->setIndex(i);
+	}
+	loggerObserver->setSourceCount(devices.size());
+	notifyObserver->setSourceCount(devices.size());
+
+	// the observers are called by a dispatcher thread, so that a slow observer does not delay the fan control
+	std::shared_ptr<msc42::patterns::AsyncObserver> asyncObserver(new msc42::patterns::AsyncObserver(
+			{loggerObserver, notifyObserver, soundObserver}, OBSERVER_QUEUE_CAPACITY));
+
 	for (const std::unique_ptr<AbstractDevice> &device : devices) {
-		if (!device->checkIfValid()) {
-			loggerObserver->notify(AbstractDevice::CONFIG_FILE_ERROR);
+		device->registerObserver(asyncObserver);
+	}
+
+	std::shared_ptr<Metrics> metrics;
+	std::unique_ptr<MetricsServer> metricsServer;
+
+	// the control server answers status requests from the metrics
+	if (vm.count(argumentMetricsPort) || vm.count(argumentMetricsSocket) || vm.count(argumentControlSocket)) {
+		metrics = std::make_shared<Metrics>(devices);
+		metrics->setObserverQueue(asyncObserver);
+
+		if (vm.count(argumentMetricsPort)) {
+			metricsServer = MetricsServer::createLoopbackServer(vm[argumentMetricsPort].as<int>(), metrics);
+		} else if (vm.count(argumentMetricsSocket)) {
+			metricsServer = MetricsServer::createUnixSocketServer(vm[argumentMetricsSocket].as<std::string>(), metrics);
+		}
+
+		if ((vm.count(argumentMetricsPort) || vm.count(argumentMetricsSocket)) && !metricsServer) {
+			std::cout << gettext("Cannot create the socket of the metrics server.") << std::endl;
 			return EXIT_FAILURE;
 		}
-	}
 
-	for (const std::unique_ptr<AbstractDevice> &device : devices) {
-		device->registerObserver(loggerObserver);
-		device->registerObserver(notifyObserver);
-		device->registerObserver(soundObserver);
+		// the metrics observer only increments counters, so it is called directly and not by the dispatcher thread
+		std::shared_ptr<MetricsObserver> metricsObserver(new MetricsObserver(metrics));
+		for (const std::unique_ptr<AbstractDevice> &device : devices) {
+			device->registerObserver(metricsObserver);
+		}
 	}
 
-	const int interval = vm[argumentInterval].as<int>();
+	// one sample per polling interval of the command line, a device with a shorter interval keeps its last sample
+	std::shared_ptr<History> history;
+	if (vm.count(argumentHistory)) {
+		const std::string historyPath = vm[argumentHistory].as<std::string>();
+		const int historyDays = vm[argumentHistoryDays].as<int>();
+		if (historyDays > 0 && interval > 0) {
+			history = History::open(historyPath, devices, std::chrono::milliseconds(interval),
+					historyDays * MILLISECONDS_PER_DAY / interval);
+		}
+
+		if (!history) {
+			std::cout << boost::format(gettext("Cannot open the history file %s.")) % historyPath << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
 
 	configuration configuration;
+	configuration.lock = std::move(lock);
+	configuration.watchdog = watchdog;
 	configuration.devices = std::move(devices);
+	configuration.configurationPath = vm[argumentConfigurationPath].as<std::string>();
 	configuration.interval = std::chrono::milliseconds(interval);
+	configuration.fileConfiguration = std::move(fileConfiguration);
+	configuration.snapshot = snapshot;
+	configuration.parallel = parallel;
+	configuration.clock = clock;
+	configuration.metrics = metrics;
+	configuration.metricsServer = std::move(metricsServer);
+	configuration.history = history;
+	if (vm.count(argumentControlSocket)) {
+		configuration.controlSocketPath = vm[argumentControlSocket].as<std::string>();
+	}
 	return std::move(configuration);
 }
 
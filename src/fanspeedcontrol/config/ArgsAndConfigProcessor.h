@@ -19,12 +19,20 @@
 #define FANSPEEDCONTROL_CONFIG_ARGSANDCONFIGPROCESSOR_H_
 
 #include <chrono>
-#include <regex>
+#include <memory>
 #include <string>
 #include <variant>
 #include <vector>
 
+#include "ConfigLoader.h"
+#include "fanspeedcontrol/control/Watchdog.h"
 #include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/metrics/History.h"
+#include "fanspeedcontrol/metrics/Metrics.h"
+#include "fanspeedcontrol/metrics/MetricsServer.h"
+#include "fanspeedcontrol/sensors/SensorSnapshot.h"
+#include "patterns/clock/Clock.h"
+#include "patterns/lock/PidFileLock.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
@@ -32,11 +40,28 @@ namespace fanspeedcontrol {
 const std::string APP_NAME = "fanspeedcontrol";
 const std::string DOMAIN_NAME = "msc42_" + APP_NAME;
 
-const std::regex REGEX_IS_INTEGER("\\d+");
+const std::string DEFAULT_PID_FILE = "/run/lock/" + DOMAIN_NAME + ".pid";
 
 struct configuration {
+	// single instance lock, declared first, so that it is released after the devices are stopped
+	std::unique_ptr<msc42::patterns::PidFileLock> lock;
+	// optional, declared before the devices, so that the watchdog process terminates after they are stopped
+	std::shared_ptr<Watchdog> watchdog;
 	std::vector<std::unique_ptr<AbstractDevice>> devices;
+	// reloaded on SIGHUP, the parameters of the reloaded file are passed to the devices and the sensors are kept
+	std::string configurationPath;
 	std::chrono::milliseconds interval;
+	FileConfiguration fileConfiguration;
+	std::shared_ptr<SensorSnapshot> snapshot;
+	bool parallel;
+	std::shared_ptr<msc42::patterns::Clock> clock;
+	// optional, the server is declared after the devices, so that it is stopped before the devices are destroyed
+	std::shared_ptr<Metrics> metrics;
+	std::unique_ptr<MetricsServer> metricsServer;
+	// optional
+	std::shared_ptr<History> history;
+	// empty without control server, the server is created in main after the devices have their final place
+	std::string controlSocketPath;
 };
 
 void setLocale();
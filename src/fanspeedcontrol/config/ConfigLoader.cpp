@@ -0,0 +1,951 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "ConfigLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/format.hpp>
+#include <json.hpp>
+#include <libintl.h>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/devices/HwmonDevice.h"
+#include "fanspeedcontrol/devices/NvidiaGpu.h"
+#include "fanspeedcontrol/devices/NvmlGpu.h"
+#include "fanspeedcontrol/devices/SimulatedDevice.h"
+#include "fanspeedcontrol/sensors/AbstractSensor.h"
+#include "fanspeedcontrol/sensors/HwmonSensor.h"
+#include "fanspeedcontrol/sensors/NvidiaGpuSensor.h"
+#include "fanspeedcontrol/sensors/SensorAggregation.h"
+#include "fanspeedcontrol/sensors/SensorSnapshot.h"
+#include "patterns/clock/Clock.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// a temperature key with more digits is not converted, so that it cannot overflow
+const std::size_t MAX_TEMPERATURE_KEY_LENGTH = 9;
+
+enum ConfigKey {
+	KEY_TYPE,
+	KEY_ID,
+	KEY_DISPLAY_NAME,
+	KEY_SYSFS_ROOT,
+	KEY_TEMPERATURE_INPUT,
+	KEY_PWM,
+	KEY_NVML_LIBRARY,
+	KEY_HYSTERESIS,
+	KEY_WARN,
+	KEY_MIN_INTERVAL,
+	KEY_MAX_INTERVAL,
+	KEY_INTERPOLATION,
+	KEY_WRITE_MIN_DELTA,
+	KEY_WRITE_MIN_DWELL,
+	KEY_DEVICES_ARRAY,
+	KEY_FANS_ARRAY,
+	KEY_SENSORS_ARRAY,
+	KEY_SENSOR_MAX_AGE,
+	KEY_NAME,
+	KEY_AGGREGATION,
+	KEY_WEIGHTS,
+	KEY_ALPHA,
+	KEY_AMBIENT,
+	KEY_HEAT_INPUT,
+	KEY_COOLING,
+	KEY_NOISE,
+	KEY_SEED,
+	KEY_LOAD,
+	KEY_LOAD_PERIOD,
+	KEY_CONTROLLER,
+	KEY_TARGET,
+	KEY_KP,
+	KEY_KI,
+	KEY_KD,
+	KEY_MIN_SPEED,
+	KEY_MAX_SPEED,
+	KEY_DERIVATIVE_FILTER,
+	KEY_FEED_FORWARD,
+	KEY_FEED_FORWARD_TIME,
+	KEY_DEFAULT_HYSTERESIS,
+	KEY_DEFAULT_WARN
+};
+
+// every member of an object is looked up once, instead of searching the object for every known key
+const std::unordered_map<std::string, ConfigKey> CONFIG_KEYS = {
+		{TYPE_KEY, KEY_TYPE}, {ID_KEY, KEY_ID}, {DISPLAY_NAME_KEY, KEY_DISPLAY_NAME},
+		{SYSFS_ROOT_KEY, KEY_SYSFS_ROOT}, {TEMPERATURE_INPUT_KEY, KEY_TEMPERATURE_INPUT}, {PWM_KEY, KEY_PWM},
+		{NVML_LIBRARY_KEY, KEY_NVML_LIBRARY}, {HYSTERESIS_KEY, KEY_HYSTERESIS}, {WARN_KEY, KEY_WARN},
+		{MIN_INTERVAL_KEY, KEY_MIN_INTERVAL}, {MAX_INTERVAL_KEY, KEY_MAX_INTERVAL},
+		{INTERPOLATION_KEY, KEY_INTERPOLATION}, {WRITE_MIN_DELTA_KEY, KEY_WRITE_MIN_DELTA},
+		{WRITE_MIN_DWELL_KEY, KEY_WRITE_MIN_DWELL}, {DEVICES_ARRAY_KEY, KEY_DEVICES_ARRAY},
+		{FANS_ARRAY_KEY, KEY_FANS_ARRAY}, {SENSORS_ARRAY_KEY, KEY_SENSORS_ARRAY},
+		{SENSOR_MAX_AGE_KEY, KEY_SENSOR_MAX_AGE}, {NAME_KEY, KEY_NAME}, {AGGREGATION_KEY, KEY_AGGREGATION},
+		{WEIGHTS_KEY, KEY_WEIGHTS}, {ALPHA_KEY, KEY_ALPHA}, {AMBIENT_KEY, KEY_AMBIENT},
+		{HEAT_INPUT_KEY, KEY_HEAT_INPUT}, {COOLING_KEY, KEY_COOLING}, {NOISE_KEY, KEY_NOISE}, {SEED_KEY, KEY_SEED},
+		{LOAD_KEY, KEY_LOAD}, {LOAD_PERIOD_KEY, KEY_LOAD_PERIOD}, {CONTROLLER_KEY, KEY_CONTROLLER},
+		{TARGET_KEY, KEY_TARGET}, {KP_KEY, KEY_KP}, {KI_KEY, KEY_KI}, {KD_KEY, KEY_KD},
+		{MIN_SPEED_KEY, KEY_MIN_SPEED}, {MAX_SPEED_KEY, KEY_MAX_SPEED},
+		{DERIVATIVE_FILTER_KEY, KEY_DERIVATIVE_FILTER}, {FEED_FORWARD_KEY, KEY_FEED_FORWARD},
+		{FEED_FORWARD_TIME_KEY, KEY_FEED_FORWARD_TIME}, {DEFAULT_HYSTERESIS_KEY, KEY_DEFAULT_HYSTERESIS},
+		{DEFAULT_WARN_KEY, KEY_DEFAULT_WARN}};
+
+// json pointer of a member of the object at path
+std::string getMemberPath(const std::string &path, const std::string &key) {
+	std::string memberPath = path;
+	memberPath += '/';
+	for (char c : key) {
+		if (c == '~') {
+			memberPath += "~0";
+		} else if (c == '/') {
+			memberPath += "~1";
+		} else {
+			memberPath += c;
+		}
+	}
+	return memberPath;
+}
+
+std::string getElementPath(const std::string &path, std::size_t index) {
+	return path + "/" + std::to_string(index);
+}
+
+// the whole document has the empty json pointer, its errors have no path
+void addError(std::vector<std::string> &errors, const std::string &path, const std::string &message) {
+	errors.push_back(path.empty() ? message : path + ": " + message);
+}
+
+// the keys of the curve are temperatures, which consist only of decimal digits
+bool isTemperatureKey(const std::string &key) {
+	if (key.empty()) {
+		return false;
+	}
+
+	for (char c : key) {
+		if (c < '0' || c > '9') {
+			return false;
+		}
+	}
+	return true;
+}
+
+int parseTemperatureKey(const std::string &key) {
+	int temperature = 0;
+	for (char c : key) {
+		temperature = temperature * 10 + (c - '0');
+	}
+	return temperature;
+}
+
+// a member of an object of the configuration file, a reader adds an error with the path of the member
+// and returns false if the value has another type
+struct Member {
+	const std::string &objectPath;
+	const std::string &key;
+	const nlohmann::json &value;
+	std::vector<std::string> &errors;
+
+	std::string getPath() const {
+		return getMemberPath(objectPath, key);
+	}
+
+	void addError(const std::string &message) const {
+		fanspeedcontrol::addError(errors, getPath(), message);
+	}
+
+	bool read(int &result) const {
+		if (value.is_number_unsigned()) {
+			if (value.get<std::uint64_t>() <= static_cast<std::uint64_t>(INT_MAX)) {
+				result = value.get<int>();
+				return true;
+			}
+		} else if (value.is_number_integer()) {
+			std::int64_t integer = value.get<std::int64_t>();
+			if (integer >= INT_MIN && integer <= INT_MAX) {
+				result = integer;
+				return true;
+			}
+		}
+
+		addError(gettext("must be an integer"));
+		return false;
+	}
+
+	bool read(unsigned int &result) const {
+		if (value.is_number_unsigned() && value.get<std::uint64_t>() <= UINT_MAX) {
+			result = value.get<unsigned int>();
+			return true;
+		}
+
+		addError(gettext("must be a positive integer"));
+		return false;
+	}
+
+	bool read(double &result) const {
+		if (value.is_number()) {
+			result = value.get<double>();
+			return true;
+		}
+
+		addError(gettext("must be a number"));
+		return false;
+	}
+
+	bool read(std::string &result) const {
+		if (value.is_string()) {
+			result = value.get_ref<const std::string &>();
+			return true;
+		}
+
+		addError(gettext("must be a string"));
+		return false;
+	}
+
+	bool read(std::vector<double> &result) const {
+		if (value.is_array() && std::all_of(value.begin(), value.end(),
+				[](const nlohmann::json &element) { return element.is_number(); })) {
+			result.clear();
+			result.reserve(value.size());
+			for (const nlohmann::json &element : value) {
+				result.push_back(element.get<double>());
+			}
+			return true;
+		}
+
+		addError(gettext("must be an array of numbers"));
+		return false;
+	}
+
+	bool read(std::vector<std::string> &result) const {
+		if (value.is_array() && std::all_of(value.begin(), value.end(),
+				[](const nlohmann::json &element) { return element.is_string(); })) {
+			result.clear();
+			result.reserve(value.size());
+			for (const nlohmann::json &element : value) {
+				result.push_back(element.get_ref<const std::string &>());
+			}
+			return true;
+		}
+
+		addError(gettext("must be an array of strings"));
+		return false;
+	}
+};
+
+void addMissingError(std::vector<std::string> &errors, const std::string &path, const std::string &key) {
+	addError(errors, getMemberPath(path, key), gettext("is missing"));
+}
+
+void parseSensor(const nlohmann::json &object, const std::string &path, SensorConfiguration &sensor,
+		std::vector<std::string> &errors) {
+	sensor.path = path;
+
+	if (!object.is_object()) {
+		addError(errors, path, gettext("must be an object"));
+		return;
+	}
+
+	bool hasName = false;
+	bool hasType = false;
+	bool typeValid = false;
+	bool hasId = false;
+	bool hasDisplayName = false;
+	bool hasTemperatureInput = false;
+
+	for (nlohmann::json::const_iterator it = object.begin(); it != object.end(); ++it) {
+		std::unordered_map<std::string, ConfigKey>::const_iterator keyIterator = CONFIG_KEYS.find(it.key());
+		if (keyIterator == CONFIG_KEYS.end()) {
+			continue;
+		}
+
+		Member member{path, it.key(), it.value(), errors};
+		switch (keyIterator->second) {
+		case KEY_NAME:
+			hasName = true;
+			member.read(sensor.name);
+			break;
+		case KEY_TYPE:
+			hasType = true;
+			typeValid = member.read(sensor.type);
+			break;
+		case KEY_ID:
+			hasId = true;
+			member.read(sensor.id);
+			break;
+		case KEY_DISPLAY_NAME:
+			hasDisplayName = true;
+			member.read(sensor.displayName);
+			break;
+		case KEY_SYSFS_ROOT:
+			member.read(sensor.sysfsRoot);
+			break;
+		case KEY_TEMPERATURE_INPUT:
+			hasTemperatureInput = true;
+			member.read(sensor.temperatureInput);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (!hasName) {
+		addMissingError(errors, path, NAME_KEY);
+	}
+
+	if (!hasType) {
+		addMissingError(errors, path, TYPE_KEY);
+	} else if (typeValid && sensor.type == TYPE_NVIDIA) {
+		if (!hasId) {
+			addMissingError(errors, path, ID_KEY);
+		}
+		if (!hasDisplayName) {
+			addMissingError(errors, path, DISPLAY_NAME_KEY);
+		}
+	} else if (typeValid && sensor.type == TYPE_HWMON) {
+		if (!hasTemperatureInput) {
+			addMissingError(errors, path, TEMPERATURE_INPUT_KEY);
+		}
+	} else if (typeValid) {
+		addError(errors, getMemberPath(path, TYPE_KEY), gettext("must be nvidia or hwmon"));
+	}
+}
+
+void parseDevice(const nlohmann::json &object, const std::string &path, int defaultHysteresis, int defaultWarn,
+		int defaultInterval, const std::unordered_map<std::string, std::size_t> &sensorIndices,
+		DeviceConfiguration &device, std::vector<std::string> &errors) {
+	device.path = path;
+
+	if (!object.is_object()) {
+		addError(errors, path, gettext("must be an object"));
+		return;
+	}
+
+	device.hysteresis = defaultHysteresis;
+	device.warn = defaultWarn;
+
+	bool hasType = false;
+	bool typeValid = false;
+	bool hasId = false;
+	bool hasDisplayName = false;
+	bool hasTemperatureInput = false;
+	bool hasPwm = false;
+	bool hasSensors = false;
+	bool hasSeed = false;
+	bool hasTarget = false;
+	bool hasFeedForward = false;
+	bool pidController = false;
+
+	std::optional<int> minInterval;
+	std::optional<int> maxInterval;
+	double loadPeriod = DEFAULT_LOAD_PERIOD;
+
+	PidController::parameters pidParameters = {0, DEFAULT_KP, DEFAULT_KI, DEFAULT_KD, DEFAULT_MIN_SPEED,
+			DEFAULT_MAX_SPEED, DEFAULT_DERIVATIVE_FILTER};
+	FeedForward::parameters feedForwardParameters = {0, DEFAULT_FEED_FORWARD_TIME};
+
+	for (nlohmann::json::const_iterator it = object.begin(); it != object.end(); ++it) {
+		const std::string &key = it.key();
+		Member member{path, key, it.value(), errors};
+
+		if (isTemperatureKey(key)) {
+			int fanSpeed;
+			if (key.size() > MAX_TEMPERATURE_KEY_LENGTH) {
+				member.addError(gettext("is not a valid temperature"));
+			} else if (member.read(fanSpeed)) {
+				device.pairs[parseTemperatureKey(key)] = fanSpeed;
+			}
+			continue;
+		}
+
+		std::unordered_map<std::string, ConfigKey>::const_iterator keyIterator = CONFIG_KEYS.find(key);
+		if (keyIterator == CONFIG_KEYS.end()) {
+			continue;
+		}
+
+		int integer;
+		std::string name;
+		std::vector<std::string> names;
+
+		switch (keyIterator->second) {
+		case KEY_TYPE:
+			hasType = true;
+			typeValid = member.read(device.type);
+			break;
+		case KEY_ID:
+			hasId = true;
+			member.read(device.id);
+			break;
+		case KEY_DISPLAY_NAME:
+			hasDisplayName = true;
+			member.read(device.displayName);
+			break;
+		case KEY_SYSFS_ROOT:
+			member.read(device.sysfsRoot);
+			break;
+		case KEY_TEMPERATURE_INPUT:
+			hasTemperatureInput = true;
+			member.read(device.temperatureInput);
+			break;
+		case KEY_PWM:
+			hasPwm = true;
+			member.read(device.pwm);
+			break;
+		case KEY_NVML_LIBRARY:
+			member.read(device.nvmlLibrary);
+			break;
+		case KEY_HYSTERESIS:
+			member.read(device.hysteresis);
+			break;
+		case KEY_WARN:
+			member.read(device.warn);
+			break;
+		case KEY_MIN_INTERVAL:
+			if (member.read(integer)) {
+				minInterval = integer;
+			}
+			break;
+		case KEY_MAX_INTERVAL:
+			if (member.read(integer)) {
+				maxInterval = integer;
+			}
+			break;
+		case KEY_INTERPOLATION:
+			if (!member.read(name)) {
+				break;
+			}
+
+			if (name == INTERPOLATION_STEP) {
+				device.interpolation = AbstractDevice::INTERPOLATION_STEP;
+			} else if (name == INTERPOLATION_LINEAR) {
+				device.interpolation = AbstractDevice::INTERPOLATION_LINEAR;
+			} else if (name == INTERPOLATION_MONOTONE_CUBIC) {
+				device.interpolation = AbstractDevice::INTERPOLATION_MONOTONE_CUBIC;
+			} else {
+				member.addError(gettext("must be step, linear or cubic"));
+			}
+			break;
+		case KEY_WRITE_MIN_DELTA:
+			member.read(device.minFanSpeedDelta);
+			break;
+		case KEY_WRITE_MIN_DWELL:
+			if (member.read(integer)) {
+				device.minFanSpeedDwell = std::chrono::milliseconds(integer);
+			}
+			break;
+		case KEY_SENSORS_ARRAY:
+			hasSensors = true;
+			if (!member.read(names)) {
+				break;
+			}
+
+			if (names.empty()) {
+				member.addError(gettext("must contain at least one sensor"));
+			}
+
+			for (std::size_t i = 0; i < names.size(); ++i) {
+				std::unordered_map<std::string, std::size_t>::const_iterator sensor = sensorIndices.find(names[i]);
+				if (sensor == sensorIndices.end()) {
+					addError(errors, getElementPath(member.getPath(), i), gettext("is not the name of a sensor"));
+				} else {
+					device.sensors.push_back(sensor->second);
+				}
+			}
+			break;
+		case KEY_AGGREGATION:
+			if (!member.read(name)) {
+				break;
+			}
+
+			if (name == AGGREGATION_MAX) {
+				device.aggregation = SensorAggregation::AGGREGATION_MAX;
+			} else if (name == AGGREGATION_MEAN) {
+				device.aggregation = SensorAggregation::AGGREGATION_MEAN;
+			} else if (name == AGGREGATION_WEIGHTED) {
+				device.aggregation = SensorAggregation::AGGREGATION_WEIGHTED;
+			} else if (name == AGGREGATION_EWMA) {
+				device.aggregation = SensorAggregation::AGGREGATION_EWMA;
+			} else {
+				member.addError(gettext("must be max, mean, weighted or ewma"));
+			}
+			break;
+		case KEY_WEIGHTS:
+			member.read(device.weights);
+			break;
+		case KEY_ALPHA:
+			member.read(device.alpha);
+			break;
+		case KEY_AMBIENT:
+			member.read(device.ambient);
+			break;
+		case KEY_HEAT_INPUT:
+			member.read(device.heatInput);
+			break;
+		case KEY_COOLING:
+			member.read(device.cooling);
+			break;
+		case KEY_NOISE:
+			member.read(device.noise);
+			break;
+		case KEY_SEED:
+			hasSeed = true;
+			member.read(device.seed);
+			break;
+		case KEY_LOAD:
+			member.read(device.load);
+			break;
+		case KEY_LOAD_PERIOD:
+			member.read(loadPeriod);
+			break;
+		case KEY_CONTROLLER:
+			if (!member.read(name)) {
+				break;
+			}
+
+			if (name == CONTROLLER_PID) {
+				pidController = true;
+			} else if (name != CONTROLLER_CURVE) {
+				member.addError(gettext("must be curve or pid"));
+			}
+			break;
+		case KEY_TARGET:
+			hasTarget = true;
+			member.read(pidParameters.target);
+			break;
+		case KEY_KP:
+			member.read(pidParameters.kp);
+			break;
+		case KEY_KI:
+			member.read(pidParameters.ki);
+			break;
+		case KEY_KD:
+			member.read(pidParameters.kd);
+			break;
+		case KEY_MIN_SPEED:
+			member.read(pidParameters.minOutput);
+			break;
+		case KEY_MAX_SPEED:
+			member.read(pidParameters.maxOutput);
+			break;
+		case KEY_DERIVATIVE_FILTER:
+			member.read(pidParameters.derivativeFilter);
+			break;
+		case KEY_FEED_FORWARD:
+			hasFeedForward = true;
+			member.read(feedForwardParameters.gain);
+			break;
+		case KEY_FEED_FORWARD_TIME:
+			member.read(feedForwardParameters.timeConstant);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (!hasType) {
+		addMissingError(errors, path, TYPE_KEY);
+	} else if (typeValid && device.type == TYPE_NVIDIA) {
+		if (!hasDisplayName) {
+			addMissingError(errors, path, DISPLAY_NAME_KEY);
+		}
+	} else if (typeValid && device.type == TYPE_HWMON) {
+		if (!hasPwm) {
+			addMissingError(errors, path, PWM_KEY);
+		}
+		// the temperature input is optional if the temperature is read from sensors
+		if (!hasTemperatureInput && !hasSensors) {
+			addMissingError(errors, path, TEMPERATURE_INPUT_KEY);
+		}
+	} else if (typeValid && device.type != TYPE_NVML && device.type != TYPE_SIMULATED) {
+		addError(errors, getMemberPath(path, TYPE_KEY), gettext("must be nvidia, nvml, hwmon or simulated"));
+	}
+
+	if (!hasId) {
+		addMissingError(errors, path, ID_KEY);
+	}
+
+	// without configured intervals the device is polled with the fixed interval of the command line
+	device.maxInterval = std::chrono::milliseconds(maxInterval.value_or(defaultInterval));
+	device.minInterval = std::chrono::milliseconds(minInterval.value_or(
+			std::min<int>(defaultInterval, device.maxInterval.count())));
+	if (!maxInterval) {
+		device.maxInterval = std::max(device.maxInterval, device.minInterval);
+	}
+
+	// the id is the default seed, so that simulated devices differ without configuration
+	if (!hasSeed) {
+		device.seed = device.id;
+	}
+	device.loadPeriod = std::chrono::milliseconds(std::lround(1000 * loadPeriod));
+
+	if (pidController) {
+		if (!hasTarget) {
+			addError(errors, getMemberPath(path, TARGET_KEY), gettext("is missing, the controller pid requires it"));
+		}
+		device.controller = pidParameters;
+	}
+
+	if (hasFeedForward) {
+		device.feedForward = feedForwardParameters;
+	}
+}
+
+bool parseConfiguration(const std::string &text, int defaultInterval, FileConfiguration &configuration,
+		std::vector<std::string> &errors) {
+	const std::size_t previousErrors = errors.size();
+	configuration = FileConfiguration();
+
+	nlohmann::json json;
+	try {
+		json = nlohmann::json::parse(text);
+	} catch (const nlohmann::json::parse_error &e) {
+		errors.push_back((boost::format(gettext("not valid JSON at byte %d")) % e.byte).str());
+		return false;
+	} catch (const nlohmann::json::exception &e) {
+		errors.push_back(gettext("not valid JSON"));
+		return false;
+	}
+
+	const std::string rootPath;
+	if (!json.is_object()) {
+		addError(errors, rootPath, gettext("the configuration must be a JSON object"));
+		return false;
+	}
+
+	int defaultHysteresis = DEFAULT_HYSTERESIS;
+	int defaultWarn = DEFAULT_WARN;
+	int sensorMaxAge = defaultInterval / 2;
+	const nlohmann::json *sensors = nullptr;
+	const nlohmann::json *deviceArrays[2] = {nullptr, nullptr};
+	const std::string *deviceArrayKeys[2] = {&DEVICES_ARRAY_KEY, &FANS_ARRAY_KEY};
+
+	for (nlohmann::json::const_iterator it = json.begin(); it != json.end(); ++it) {
+		std::unordered_map<std::string, ConfigKey>::const_iterator keyIterator = CONFIG_KEYS.find(it.key());
+		if (keyIterator == CONFIG_KEYS.end()) {
+			continue;
+		}
+
+		Member member{rootPath, it.key(), it.value(), errors};
+		switch (keyIterator->second) {
+		case KEY_DEFAULT_HYSTERESIS:
+			member.read(defaultHysteresis);
+			break;
+		case KEY_DEFAULT_WARN:
+			member.read(defaultWarn);
+			break;
+		case KEY_SENSOR_MAX_AGE:
+			member.read(sensorMaxAge);
+			break;
+		case KEY_SENSORS_ARRAY:
+			sensors = &it.value();
+			break;
+		case KEY_DEVICES_ARRAY:
+			deviceArrays[0] = &it.value();
+			break;
+		case KEY_FANS_ARRAY:
+			deviceArrays[1] = &it.value();
+			break;
+		default:
+			break;
+		}
+	}
+
+	configuration.sensorMaxAge = std::chrono::milliseconds(sensorMaxAge);
+
+	// without a device array the whole object is a single device, which cannot use shared sensors
+	if (!deviceArrays[0] && !deviceArrays[1]) {
+		configuration.devices.emplace_back();
+		parseDevice(json, rootPath, defaultHysteresis, defaultWarn, defaultInterval,
+				std::unordered_map<std::string, std::size_t>(), configuration.devices.back(), errors);
+		return errors.size() == previousErrors;
+	}
+
+	std::unordered_map<std::string, std::size_t> sensorIndices;
+	if (sensors) {
+		const std::string sensorsPath = getMemberPath(rootPath, SENSORS_ARRAY_KEY);
+		if (!sensors->is_array()) {
+			addError(errors, sensorsPath, gettext("must be an array"));
+		} else {
+			configuration.sensors.resize(sensors->size());
+			for (std::size_t i = 0; i < sensors->size(); ++i) {
+				const std::string sensorPath = getElementPath(sensorsPath, i);
+				SensorConfiguration &sensor = configuration.sensors[i];
+				parseSensor((*sensors)[i], sensorPath, sensor, errors);
+
+				if (!sensor.name.empty() && !sensorIndices.emplace(sensor.name, i).second) {
+					addError(errors, getMemberPath(sensorPath, NAME_KEY), gettext("is the name of another sensor"));
+				}
+			}
+		}
+	}
+
+	for (std::size_t array = 0; array < 2; ++array) {
+		if (!deviceArrays[array]) {
+			continue;
+		}
+
+		const std::string arrayPath = getMemberPath(rootPath, *deviceArrayKeys[array]);
+		if (!deviceArrays[array]->is_array()) {
+			addError(errors, arrayPath, gettext("must be an array"));
+			continue;
+		}
+
+		configuration.devices.reserve(configuration.devices.size() + deviceArrays[array]->size());
+		for (std::size_t i = 0; i < deviceArrays[array]->size(); ++i) {
+			configuration.devices.emplace_back();
+			parseDevice((*deviceArrays[array])[i], getElementPath(arrayPath, i), defaultHysteresis, defaultWarn,
+					defaultInterval, sensorIndices, configuration.devices.back(), errors);
+		}
+	}
+
+	if (configuration.devices.empty()) {
+		addError(errors, getMemberPath(rootPath, DEVICES_ARRAY_KEY), gettext("must contain at least one device"));
+	}
+
+	return errors.size() == previousErrors;
+}
+
+std::shared_ptr<SensorAggregation> createTemperatureSource(const DeviceConfiguration &configuration,
+		const std::shared_ptr<SensorSnapshot> &snapshot) {
+	return std::make_shared<SensorAggregation>(snapshot, configuration.sensors, configuration.aggregation,
+			configuration.weights, configuration.alpha);
+}
+
+// the parameters of a device, which can be changed while it is controlled
+void setParameters(const DeviceConfiguration &configuration,
+		const std::shared_ptr<SensorAggregation> &temperatureSource, AbstractDevice::Parameters &changed) {
+	changed.hysteresis = configuration.hysteresis;
+	changed.warn = configuration.warn;
+	changed.pairs = configuration.pairs;
+	changed.interpolation = configuration.interpolation;
+	changed.minInterval = configuration.minInterval;
+	changed.maxInterval = configuration.maxInterval;
+	changed.minFanSpeedDelta = configuration.minFanSpeedDelta;
+	changed.minFanSpeedDwell = configuration.minFanSpeedDwell;
+	changed.temperatureSource = temperatureSource;
+	changed.controller = configuration.controller;
+	changed.feedForward = configuration.feedForward;
+}
+
+void addInvalidAttributes(std::vector<std::string> &errors, const std::string &path,
+		const InvalidAttributes &invalidAttributes) {
+	for (const InvalidAttribute &invalidAttribute : invalidAttributes) {
+		addError(errors, invalidAttribute.attribute.empty() ? path : getMemberPath(path, invalidAttribute.attribute),
+				invalidAttribute.message);
+	}
+}
+
+std::unique_ptr<AbstractDevice> createDevice(const DeviceConfiguration &configuration,
+		const std::shared_ptr<SensorSnapshot> &snapshot) {
+	std::unique_ptr<AbstractDevice> device;
+
+	if (configuration.type == TYPE_NVIDIA) {
+		device.reset(new NvidiaGpu(configuration.id, configuration.hysteresis, configuration.warn, configuration.pairs,
+				configuration.displayName));
+	} else if (configuration.type == TYPE_NVML) {
+		device.reset(new NvmlGpu(configuration.id, configuration.hysteresis, configuration.warn, configuration.pairs,
+				configuration.nvmlLibrary));
+	} else if (configuration.type == TYPE_HWMON) {
+		device.reset(new HwmonDevice(configuration.id, configuration.hysteresis, configuration.warn,
+				configuration.pairs, configuration.sysfsRoot, configuration.temperatureInput, configuration.pwm));
+	} else {
+		device.reset(new SimulatedDevice(configuration.id, configuration.hysteresis, configuration.warn,
+				configuration.pairs, configuration.ambient, configuration.heatInput, configuration.cooling,
+				configuration.noise, configuration.seed, configuration.load, configuration.loadPeriod));
+	}
+
+	std::shared_ptr<SensorAggregation> temperatureSource;
+	if (snapshot && !configuration.sensors.empty()) {
+		temperatureSource = createTemperatureSource(configuration, snapshot);
+	}
+
+	device->setParameters([&configuration, &temperatureSource](AbstractDevice::Parameters &changed) {
+		setParameters(configuration, temperatureSource, changed);
+	});
+
+	return device;
+}
+
+std::vector<std::unique_ptr<AbstractDevice>> createDevices(const FileConfiguration &configuration,
+		const std::shared_ptr<msc42::patterns::Clock> &clock, std::vector<std::string> &errors) {
+	std::shared_ptr<SensorSnapshot> snapshot;
+	return createDevices(configuration, clock, snapshot, errors);
+}
+
+std::vector<std::unique_ptr<AbstractDevice>> createDevices(const FileConfiguration &configuration,
+		const std::shared_ptr<msc42::patterns::Clock> &clock, std::shared_ptr<SensorSnapshot> &snapshot,
+		std::vector<std::string> &errors) {
+	const std::size_t previousErrors = errors.size();
+	snapshot = std::make_shared<SensorSnapshot>(configuration.sensorMaxAge, clock);
+
+	for (const SensorConfiguration &sensor : configuration.sensors) {
+		if (sensor.type == TYPE_NVIDIA) {
+			snapshot->addSensor(std::unique_ptr<AbstractSensor>(new NvidiaGpuSensor(sensor.name, sensor.id,
+					sensor.displayName)));
+		} else {
+			snapshot->addSensor(std::unique_ptr<AbstractSensor>(new HwmonSensor(sensor.name, sensor.sysfsRoot,
+					sensor.temperatureInput)));
+		}
+
+		if (!snapshot->getSensor(snapshot->size() - 1).checkIfValid()) {
+			addError(errors, sensor.type == TYPE_HWMON ? getMemberPath(sensor.path, TEMPERATURE_INPUT_KEY)
+					: sensor.path, gettext("cannot be opened"));
+		}
+	}
+
+	std::vector<std::unique_ptr<AbstractDevice>> devices;
+	devices.reserve(configuration.devices.size());
+
+	for (const DeviceConfiguration &deviceConfiguration : configuration.devices) {
+		devices.push_back(createDevice(deviceConfiguration, snapshot));
+		devices.back()->setClock(clock);
+
+		InvalidAttributes invalidAttributes;
+		devices.back()->checkAttributes(invalidAttributes);
+		addInvalidAttributes(errors, deviceConfiguration.path, invalidAttributes);
+	}
+
+	if (errors.size() != previousErrors) {
+		return std::vector<std::unique_ptr<AbstractDevice>>();
+	}
+
+	return devices;
+}
+
+bool hasSameHardware(const DeviceConfiguration &configuration, const DeviceConfiguration &other) {
+	if (configuration.type != other.type || configuration.id != other.id) {
+		return false;
+	}
+
+	if (configuration.type == TYPE_NVIDIA) {
+		return configuration.displayName == other.displayName;
+	} else if (configuration.type == TYPE_NVML) {
+		return configuration.nvmlLibrary == other.nvmlLibrary;
+	} else if (configuration.type == TYPE_HWMON) {
+		return configuration.sysfsRoot == other.sysfsRoot && configuration.temperatureInput == other.temperatureInput
+				&& configuration.pwm == other.pwm;
+	}
+
+	// the model is the hardware of a simulated device
+	return configuration.ambient == other.ambient && configuration.heatInput == other.heatInput
+			&& configuration.cooling == other.cooling && configuration.noise == other.noise
+			&& configuration.load == other.load && configuration.loadPeriod == other.loadPeriod;
+}
+
+bool hasSameSensors(const FileConfiguration &configuration, const FileConfiguration &other) {
+	return std::equal(configuration.sensors.begin(), configuration.sensors.end(), other.sensors.begin(),
+			other.sensors.end(), [](const SensorConfiguration &sensor, const SensorConfiguration &otherSensor) {
+		return sensor.name == otherSensor.name && sensor.type == otherSensor.type && sensor.id == otherSensor.id
+				&& sensor.displayName == otherSensor.displayName && sensor.sysfsRoot == otherSensor.sysfsRoot
+				&& sensor.temperatureInput == otherSensor.temperatureInput;
+	});
+}
+
+std::vector<std::function<void(AbstractDevice::Parameters &)>> createParameterChanges(
+		const FileConfiguration &configuration, const FileConfiguration &runningConfiguration,
+		const std::vector<std::unique_ptr<AbstractDevice>> &devices, const std::shared_ptr<SensorSnapshot> &snapshot,
+		std::vector<std::string> &errors) {
+	const std::size_t previousErrors = errors.size();
+
+	std::vector<std::function<void(AbstractDevice::Parameters &)>> changes;
+	changes.reserve(devices.size());
+
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		const DeviceConfiguration &deviceConfiguration = configuration.devices[i];
+		const DeviceConfiguration &runningDeviceConfiguration = runningConfiguration.devices[i];
+
+		// a running temperature source is kept with its state, e.g. the moving average
+		std::shared_ptr<SensorAggregation> temperatureSource;
+		if (deviceConfiguration.sensors == runningDeviceConfiguration.sensors
+				&& deviceConfiguration.aggregation == runningDeviceConfiguration.aggregation
+				&& deviceConfiguration.weights == runningDeviceConfiguration.weights
+				&& deviceConfiguration.alpha == runningDeviceConfiguration.alpha) {
+			temperatureSource = devices[i]->getParameters().temperatureSource;
+		} else if (!deviceConfiguration.sensors.empty()) {
+			temperatureSource = createTemperatureSource(deviceConfiguration, snapshot);
+		}
+
+		// the change is applied later by another thread, so it keeps a copy of the configuration of the device
+		changes.push_back([deviceConfiguration, temperatureSource](AbstractDevice::Parameters &changed) {
+			setParameters(deviceConfiguration, temperatureSource, changed);
+		});
+
+		InvalidAttributes invalidAttributes;
+		devices[i]->checkChangedParameters(changes.back(), invalidAttributes);
+		addInvalidAttributes(errors, deviceConfiguration.path, invalidAttributes);
+	}
+
+	if (errors.size() != previousErrors) {
+		return std::vector<std::function<void(AbstractDevice::Parameters &)>>();
+	}
+
+	return changes;
+}
+
+bool readConfiguration(const std::string &file, int defaultInterval, FileConfiguration &configuration,
+		std::vector<std::string> &errors) {
+	std::ifstream fileStream(file);
+	if (!fileStream) {
+		errors.push_back((boost::format(gettext("cannot read the file %s")) % file).str());
+		return false;
+	}
+
+	// the parser reads from memory much faster than from a stream
+	std::ostringstream text;
+	text << fileStream.rdbuf();
+
+	return parseConfiguration(text.str(), defaultInterval, configuration, errors);
+}
+
+std::vector<std::unique_ptr<AbstractDevice>> loadDevices(const std::string &file, int defaultInterval,
+		const std::shared_ptr<msc42::patterns::Clock> &clock, std::vector<std::string> &errors) {
+	FileConfiguration configuration;
+	if (!readConfiguration(file, defaultInterval, configuration, errors)) {
+		return std::vector<std::unique_ptr<AbstractDevice>>();
+	}
+
+	return createDevices(configuration, clock, errors);
+}
+
+std::string joinErrors(const std::vector<std::string> &errors) {
+	std::string joined;
+	for (const std::string &error : errors) {
+		if (!joined.empty()) {
+			joined += "; ";
+		}
+		joined += error;
+	}
+	return joined;
+}
+
+}
+}
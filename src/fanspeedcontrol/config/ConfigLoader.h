@@ -0,0 +1,228 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef FANSPEEDCONTROL_CONFIG_CONFIGLOADER_H_
+#define FANSPEEDCONTROL_CONFIG_CONFIGLOADER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "fanspeedcontrol/control/FeedForward.h"
+#include "fanspeedcontrol/control/PidController.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/sensors/SensorAggregation.h"
+#include "fanspeedcontrol/sensors/SensorSnapshot.h"
+#include "patterns/clock/Clock.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+const int DEFAULT_WARN = 100;
+const int DEFAULT_HYSTERESIS = 0;
+
+const std::string TYPE_KEY = "type";
+const std::string ID_KEY = "id";
+const std::string DISPLAY_NAME_KEY = "displayName";
+const std::string SYSFS_ROOT_KEY = "sysfsRoot";
+const std::string TEMPERATURE_INPUT_KEY = "temperatureInput";
+const std::string PWM_KEY = "pwm";
+const std::string NVML_LIBRARY_KEY = "nvmlLibrary";
+const std::string HYSTERESIS_KEY = "hysteresis";
+const std::string WARN_KEY = "warn";
+const std::string MIN_INTERVAL_KEY = "minInterval";
+const std::string MAX_INTERVAL_KEY = "maxInterval";
+const std::string INTERPOLATION_KEY = "interpolation";
+const std::string WRITE_MIN_DELTA_KEY = "writeMinDelta";
+const std::string WRITE_MIN_DWELL_KEY = "writeMinDwell";
+const std::string DEVICES_ARRAY_KEY = "devices";
+const std::string FANS_ARRAY_KEY = "fans";
+const std::string SENSORS_ARRAY_KEY = "sensors";
+const std::string SENSOR_MAX_AGE_KEY = "sensorMaxAge";
+const std::string NAME_KEY = "name";
+const std::string AGGREGATION_KEY = "aggregation";
+const std::string WEIGHTS_KEY = "weights";
+const std::string ALPHA_KEY = "alpha";
+const std::string AMBIENT_KEY = "ambient";
+const std::string HEAT_INPUT_KEY = "heatInput";
+const std::string COOLING_KEY = "cooling";
+const std::string NOISE_KEY = "noise";
+const std::string SEED_KEY = "seed";
+const std::string LOAD_KEY = "load";
+const std::string LOAD_PERIOD_KEY = "loadPeriod";
+const std::string CONTROLLER_KEY = "controller";
+const std::string TARGET_KEY = "target";
+const std::string KP_KEY = "kp";
+const std::string KI_KEY = "ki";
+const std::string KD_KEY = "kd";
+const std::string MIN_SPEED_KEY = "minSpeed";
+const std::string MAX_SPEED_KEY = "maxSpeed";
+const std::string DERIVATIVE_FILTER_KEY = "derivativeFilter";
+const std::string FEED_FORWARD_KEY = "feedForward";
+const std::string FEED_FORWARD_TIME_KEY = "feedForwardTime";
+const std::string DEFAULT_HYSTERESIS_KEY = "defaultHysteresis";
+const std::string DEFAULT_WARN_KEY = "defaultWarn";
+
+const std::string TYPE_NVIDIA = "nvidia";
+const std::string TYPE_HWMON = "hwmon";
+const std::string TYPE_NVML = "nvml";
+const std::string TYPE_SIMULATED = "simulated";
+
+const std::string DEFAULT_SYSFS_ROOT = "/sys/class/hwmon";
+const std::string DEFAULT_NVML_LIBRARY = "libnvidia-ml.so.1";
+
+const double DEFAULT_AMBIENT = 25;
+const double DEFAULT_HEAT_INPUT = 1;
+const double DEFAULT_COOLING = 0.05;
+const double DEFAULT_NOISE = 0;
+const int DEFAULT_LOAD = 100;
+const double DEFAULT_LOAD_PERIOD = 0;
+
+const std::string CONTROLLER_CURVE = "curve";
+const std::string CONTROLLER_PID = "pid";
+
+const double DEFAULT_KP = 5;
+const double DEFAULT_KI = 0.1;
+const double DEFAULT_KD = 0;
+const double DEFAULT_MIN_SPEED = 0;
+const double DEFAULT_MAX_SPEED = 100;
+const double DEFAULT_DERIVATIVE_FILTER = 1;
+const double DEFAULT_FEED_FORWARD_TIME = 10;
+
+const std::string AGGREGATION_MAX = "max";
+const std::string AGGREGATION_MEAN = "mean";
+const std::string AGGREGATION_WEIGHTED = "weighted";
+const std::string AGGREGATION_EWMA = "ewma";
+
+const std::string INTERPOLATION_STEP = "step";
+const std::string INTERPOLATION_LINEAR = "linear";
+const std::string INTERPOLATION_MONOTONE_CUBIC = "cubic";
+
+// a shared sensor of the multi device configuration
+struct SensorConfiguration {
+	// json pointer of the sensor in the file, the errors of the opened sensor begin with it
+	std::string path;
+	std::string name;
+	std::string type;
+	int id = 0;
+	std::string displayName;
+	std::string sysfsRoot = DEFAULT_SYSFS_ROOT;
+	std::string temperatureInput;
+};
+
+// a device of the configuration file, the defaults of the file and of the command line are applied
+struct DeviceConfiguration {
+	// json pointer of the device in the file, the errors of the checked device begin with it
+	std::string path;
+	std::string type;
+	int id = 0;
+	int hysteresis = DEFAULT_HYSTERESIS;
+	int warn = DEFAULT_WARN;
+	std::map<int, int> pairs;
+	std::chrono::milliseconds minInterval;
+	std::chrono::milliseconds maxInterval;
+	AbstractDevice::Interpolation interpolation = AbstractDevice::INTERPOLATION_STEP;
+	int minFanSpeedDelta = 0;
+	std::chrono::milliseconds minFanSpeedDwell = std::chrono::milliseconds::zero();
+
+	std::string displayName;
+	std::string sysfsRoot = DEFAULT_SYSFS_ROOT;
+	std::string temperatureInput;
+	std::string pwm;
+	std::string nvmlLibrary = DEFAULT_NVML_LIBRARY;
+
+	double ambient = DEFAULT_AMBIENT;
+	double heatInput = DEFAULT_HEAT_INPUT;
+	double cooling = DEFAULT_COOLING;
+	double noise = DEFAULT_NOISE;
+	unsigned int seed = 0;
+	int load = DEFAULT_LOAD;
+	std::chrono::milliseconds loadPeriod = std::chrono::milliseconds::zero();
+
+	// positions in the sensors of the file, empty if the temperature is read from the device
+	std::vector<std::size_t> sensors;
+	SensorAggregation::Type aggregation = SensorAggregation::AGGREGATION_MAX;
+	std::vector<double> weights;
+	double alpha = 1;
+
+	std::optional<PidController::parameters> controller;
+	std::optional<FeedForward::parameters> feedForward;
+};
+
+struct FileConfiguration {
+	std::chrono::milliseconds sensorMaxAge;
+	std::vector<SensorConfiguration> sensors;
+	// the devices of the array devices followed by the fans
+	std::vector<DeviceConfiguration> devices;
+};
+
+// parses the text and checks the types and required attributes in a single pass over every object without opening
+// a device, every error begins with the json pointer of the value (e.g. /devices/1/warn), returns false if there
+// is an error, the errors of all values are reported
+bool parseConfiguration(const std::string &text, int defaultInterval, FileConfiguration &configuration,
+		std::vector<std::string> &errors);
+
+// reads and parses the file like parseConfiguration, e.g. to open the devices later with createDevices
+bool readConfiguration(const std::string &file, int defaultInterval, FileConfiguration &configuration,
+		std::vector<std::string> &errors);
+
+// opens a device of a parsed configuration without checking it, its temperature is aggregated from the sensors
+// of the snapshot if the configuration has sensors and a snapshot is given
+std::unique_ptr<AbstractDevice> createDevice(const DeviceConfiguration &configuration,
+		const std::shared_ptr<SensorSnapshot> &snapshot);
+
+// opens the sensors and the devices of a parsed configuration and checks the values, which depend on each other
+// or on the hardware (e.g. the curve, the intervals and the files of hwmon devices), returns an empty vector
+// and adds an error with the json pointer of the attribute for every invalid value if one is not valid
+std::vector<std::unique_ptr<AbstractDevice>> createDevices(const FileConfiguration &configuration,
+		const std::shared_ptr<msc42::patterns::Clock> &clock, std::vector<std::string> &errors);
+// like createDevices, the opened sensors are returned in snapshot, e.g. to keep them for a reloaded configuration
+std::vector<std::unique_ptr<AbstractDevice>> createDevices(const FileConfiguration &configuration,
+		const std::shared_ptr<msc42::patterns::Clock> &clock, std::shared_ptr<SensorSnapshot> &snapshot,
+		std::vector<std::string> &errors);
+
+// true if the other device controls the same fan in the same way, e.g. the device of a reloaded configuration
+bool hasSameHardware(const DeviceConfiguration &configuration, const DeviceConfiguration &other);
+// true if the other configuration has the same sensors in the same order, so that the opened sensors can be kept
+bool hasSameSensors(const FileConfiguration &configuration, const FileConfiguration &other);
+
+// creates the changes of the parameters of the running devices, which were created from runningConfiguration,
+// to a configuration with the same hardware and sensors (e.g. a reloaded configuration) and checks them without
+// opening a device or a sensor, the temperature sources with unchanged attributes are kept, returns an empty vector
+// and adds an error with the json pointer of the attribute for every invalid value if one is not valid
+std::vector<std::function<void(AbstractDevice::Parameters &)>> createParameterChanges(
+		const FileConfiguration &configuration, const FileConfiguration &runningConfiguration,
+		const std::vector<std::unique_ptr<AbstractDevice>> &devices, const std::shared_ptr<SensorSnapshot> &snapshot,
+		std::vector<std::string> &errors);
+
+// returns an empty vector and all errors if the file cannot be read or is not valid, the returned devices are valid
+std::vector<std::unique_ptr<AbstractDevice>> loadDevices(const std::string &file, int defaultInterval,
+		const std::shared_ptr<msc42::patterns::Clock> &clock, std::vector<std::string> &errors);
+
+// the errors in a line, e.g. for a log message
+std::string joinErrors(const std::vector<std::string> &errors);
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_CONFIG_CONFIGLOADER_H_ */
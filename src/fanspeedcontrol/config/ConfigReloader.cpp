@@ -0,0 +1,114 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "ConfigReloader.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ConfigLoader.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/sensors/SensorSnapshot.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// the flag is set by a signal handler, which cannot wake up a thread, so it is polled
+const std::chrono::milliseconds ConfigReloader::POLL_INTERVAL(100);
+
+ConfigReloader::ConfigReloader(const std::string &file, int defaultInterval, const FileConfiguration &configuration,
+		const std::shared_ptr<SensorSnapshot> &snapshot, const std::vector<std::unique_ptr<AbstractDevice>> &devices,
+		std::atomic<bool> &reloadFlag)
+: file(file), defaultInterval(defaultInterval), configuration(configuration), snapshot(snapshot), devices(devices),
+  reloadFlag(reloadFlag), stopFlag(false), reloader(&ConfigReloader::run, this) {
+}
+
+ConfigReloader::~ConfigReloader() {
+	stopFlag = true;
+	reloader.join();
+}
+
+bool ConfigReloader::reload() {
+	std::vector<std::string> errors;
+	FileConfiguration reloadedConfiguration;
+
+	if (!readConfiguration(file, defaultInterval, reloadedConfiguration, errors)) {
+		notifyObservers(AbstractDevice::CONFIG_RELOAD_ERROR, joinErrors(errors));
+		return false;
+	}
+
+	// adding or removing a device needs a restart, because the observers and metrics have tables of the devices,
+	// the sensors are opened only once, because they are shared by the running devices
+	if (reloadedConfiguration.devices.size() != devices.size()
+			|| !hasSameSensors(configuration, reloadedConfiguration)) {
+		notifyObservers(AbstractDevice::CONFIG_RELOAD_DEVICES_CHANGED);
+		return false;
+	}
+
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		if (!hasSameHardware(configuration.devices[i], reloadedConfiguration.devices[i])) {
+			notifyObservers(AbstractDevice::CONFIG_RELOAD_DEVICES_CHANGED, devices[i]->to_string());
+			return false;
+		}
+	}
+
+	std::vector<std::function<void(AbstractDevice::Parameters &)>> changes = createParameterChanges(
+			reloadedConfiguration, configuration, devices, snapshot, errors);
+
+	if (changes.empty()) {
+		notifyObservers(AbstractDevice::CONFIG_RELOAD_ERROR, joinErrors(errors));
+		return false;
+	}
+
+	// the configuration is passed only after every device is checked, so that it is applied completely or not at all
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		devices[i]->setParameters(changes[i]);
+	}
+	snapshot->setMaxAge(reloadedConfiguration.sensorMaxAge);
+
+	configuration = std::move(reloadedConfiguration);
+
+	notifyObservers(AbstractDevice::CONFIG_RELOADED, file);
+	return true;
+}
+
+void ConfigReloader::run() {
+	while (!stopFlag) {
+		if (reloadFlag.load(std::memory_order_relaxed) && reloadFlag.exchange(false)) {
+			reload();
+		}
+
+		std::this_thread::sleep_for(POLL_INTERVAL);
+	}
+}
+
+void ConfigReloader::notifyObservers(int messageId, const std::string &message) const {
+	// all devices have the same observers, which are thread-safe for text messages
+	if (!devices.empty()) {
+		devices.front()->notifyObservers(messageId, message);
+	}
+}
+
+}
+}
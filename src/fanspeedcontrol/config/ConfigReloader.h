@@ -0,0 +1,75 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_CONFIG_CONFIGRELOADER_H_
+#define FANSPEEDCONTROL_CONFIG_CONFIGRELOADER_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConfigLoader.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/sensors/SensorSnapshot.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// reloads the configuration file in its own thread when the reload flag is set (e.g. by SIGHUP),
+// so that reading and validating it does not delay the control,
+// the running devices keep their state, hardware and sensors and take the parameters of the reloaded configuration,
+// which is only parsed and checked without opening a device or a sensor, an invalid configuration
+// or a configuration with other devices or sensors is rejected and the running configuration is kept
+class ConfigReloader {
+public:
+	// the devices and the sensors of the snapshot are created from the parsed configuration
+	ConfigReloader(const std::string &file, int defaultInterval, const FileConfiguration &configuration,
+			const std::shared_ptr<SensorSnapshot> &snapshot, const std::vector<std::unique_ptr<AbstractDevice>> &devices,
+			std::atomic<bool> &reloadFlag);
+	virtual ~ConfigReloader();
+
+	ConfigReloader(const ConfigReloader &) = delete;
+	ConfigReloader &operator=(const ConfigReloader &) = delete;
+
+	// returns false if the configuration is rejected
+	bool reload();
+
+private:
+	static const std::chrono::milliseconds POLL_INTERVAL;
+
+	const std::string file;
+	const int defaultInterval;
+	// the configuration of the running devices, changed only by the thread of the reloader
+	FileConfiguration configuration;
+	const std::shared_ptr<SensorSnapshot> snapshot;
+	const std::vector<std::unique_ptr<AbstractDevice>> &devices;
+	std::atomic<bool> &reloadFlag;
+
+	std::atomic<bool> stopFlag;
+	std::thread reloader;
+
+	void run();
+	void notifyObservers(int messageId, const std::string &message = "") const;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_CONFIG_CONFIGRELOADER_H_ */
@@ -0,0 +1,179 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "ControlLoop.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/metrics/Metrics.h"
+#include "fanspeedcontrol/metrics/TickLatencies.h"
+#include "patterns/clock/Clock.h"
+#include "Scheduler.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+ControlLoop::ControlLoop(const std::vector<std::unique_ptr<AbstractDevice>> &devices, std::atomic<bool> &stopFlag,
+		std::atomic<bool> &reportFlag, const std::shared_ptr<msc42::patterns::Clock> &clock,
+		const std::shared_ptr<Metrics> &metrics, const std::shared_ptr<Watchdog> &watchdog,
+		const std::shared_ptr<History> &history)
+: devices(devices), stopFlag(stopFlag), reportFlag(reportFlag), clock(clock), overruns(0), metrics(metrics),
+  watchdog(watchdog), history(history), latencies(new TickLatencies[devices.size()]) {
+}
+
+ControlLoop::~ControlLoop() {
+}
+
+void ControlLoop::runSequential() {
+	Scheduler scheduler;
+	std::chrono::steady_clock::time_point now = clock->now();
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		scheduler.schedule(now, i);
+	}
+
+	while (!scheduler.empty() && sleepUntil(scheduler.next().deadline, 0, devices.size())) {
+		Scheduler::entry entry = scheduler.pop();
+
+		tick(entry.index, entry.deadline);
+
+		scheduler.schedule(nextDeadline(entry.index, entry.deadline, devices[entry.index]->getPollInterval()),
+				entry.index);
+	}
+
+	report();
+}
+
+void ControlLoop::runParallel() {
+	std::vector<std::thread> workers;
+	workers.reserve(devices.size());
+
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		workers.emplace_back(&ControlLoop::controlDevice, this, i);
+	}
+
+	// the devices must not be destroyed before every worker is finished,
+	// because a worker could be in the middle of setting the fan speed
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+
+	report();
+}
+
+unsigned long ControlLoop::getOverruns() const {
+	return overruns;
+}
+
+void ControlLoop::tick(std::size_t index, std::chrono::steady_clock::time_point deadline) {
+	AbstractDevice &device = *devices[index];
+
+	if (watchdog) {
+		watchdog->startControl(index);
+	}
+
+	std::chrono::steady_clock::time_point start = clock->now();
+	device.setOptimalFanSpeed();
+	std::chrono::steady_clock::duration duration = clock->now() - start;
+
+	latencies[index].record(device.getLastPhaseDurations(), device.getAvoidedWrites(), duration, start - deadline);
+	if (metrics) {
+		metrics->recordTick(index, device, duration);
+	}
+	if (history) {
+		history->record(index, device);
+	}
+	if (watchdog) {
+		watchdog->endControl(index);
+	}
+
+	// the flag is set by a signal handler, the report is sent by the first control thread which sees it
+	if (reportFlag.load(std::memory_order_relaxed) && reportFlag.exchange(false)) {
+		report();
+	}
+}
+
+void ControlLoop::report() const {
+	// in the parallel mode the other devices are controlled by other threads meanwhile, so the report is built
+	// only from the atomics of the latencies and the constant type and id of the devices
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		devices[i]->notifyObservers(AbstractDevice::LATENCY_REPORT, devices[i]->to_string(), latencies[i].to_string());
+	}
+}
+
+void ControlLoop::controlDevice(std::size_t index) {
+	try {
+		std::chrono::steady_clock::time_point deadline = clock->now();
+
+		while (!stopFlag) {
+			tick(index, deadline);
+
+			deadline = nextDeadline(index, deadline, devices[index]->getPollInterval());
+			sleepUntil(deadline, index, index + 1);
+		}
+	} catch (...) {
+		// an exception in one worker stops all workers like in the sequential mode,
+		// so that the destructors of all devices are called
+		stopFlag = true;
+	}
+}
+
+std::chrono::steady_clock::time_point ControlLoop::nextDeadline(std::size_t index,
+		std::chrono::steady_clock::time_point deadline, const std::chrono::milliseconds &interval) {
+	std::chrono::steady_clock::time_point now = clock->now();
+	deadline += interval;
+
+	// do not try to catch up missed iterations, start a new interval from now instead
+	if (deadline < now) {
+		++overruns;
+		latencies[index].countOverrun();
+		return now;
+	}
+
+	return deadline;
+}
+
+bool ControlLoop::sleepUntil(std::chrono::steady_clock::time_point deadline, std::size_t first,
+		std::size_t last) {
+	while (!stopFlag) {
+		// the heartbeat does not depend on the polling interval, which can be longer than the timeout of the watchdog
+		if (watchdog) {
+			for (std::size_t i = first; i < last; ++i) {
+				watchdog->beat(i);
+			}
+		}
+
+		std::chrono::steady_clock::time_point now = clock->now();
+		if (now >= deadline) {
+			return true;
+		}
+
+		clock->sleepFor(std::min<std::chrono::steady_clock::duration>(deadline - now, MAX_SLEEP_TIME));
+	}
+
+	return false;
+}
+
+}
+}
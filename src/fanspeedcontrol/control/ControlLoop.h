@@ -0,0 +1,80 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_CONTROL_CONTROLLOOP_H_
+#define FANSPEEDCONTROL_CONTROL_CONTROLLOOP_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "fanspeedcontrol/control/Watchdog.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/metrics/History.h"
+#include "fanspeedcontrol/metrics/Metrics.h"
+#include "fanspeedcontrol/metrics/TickLatencies.h"
+#include "patterns/clock/Clock.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// sleep max MAX_SLEEP_TIME milliseconds to ensure to have enough time to call the destructor
+// between sigterm and sigkill by system shutdown
+const std::chrono::milliseconds MAX_SLEEP_TIME(100);
+
+class ControlLoop {
+public:
+	// if reportFlag is set, the latencies are reported to the observers of the devices and the flag is reset,
+	// metrics, the watchdog and the history are optional
+	ControlLoop(const std::vector<std::unique_ptr<AbstractDevice>> &devices, std::atomic<bool> &stopFlag,
+			std::atomic<bool> &reportFlag, const std::shared_ptr<msc42::patterns::Clock> &clock,
+			const std::shared_ptr<Metrics> &metrics = std::shared_ptr<Metrics>(),
+			const std::shared_ptr<Watchdog> &watchdog = std::shared_ptr<Watchdog>(),
+			const std::shared_ptr<History> &history = std::shared_ptr<History>());
+	virtual ~ControlLoop();
+
+	void runSequential();
+	void runParallel();
+
+	unsigned long getOverruns() const;
+
+private:
+	const std::vector<std::unique_ptr<AbstractDevice>> &devices;
+	std::atomic<bool> &stopFlag;
+	std::atomic<bool> &reportFlag;
+	const std::shared_ptr<msc42::patterns::Clock> clock;
+	std::atomic<unsigned long> overruns;
+	const std::shared_ptr<Metrics> metrics;
+	const std::shared_ptr<Watchdog> watchdog;
+	const std::shared_ptr<History> history;
+	std::unique_ptr<TickLatencies[]> latencies;
+
+	void tick(std::size_t index, std::chrono::steady_clock::time_point deadline);
+	void report() const;
+	void controlDevice(std::size_t index);
+	std::chrono::steady_clock::time_point nextDeadline(std::size_t index, std::chrono::steady_clock::time_point deadline,
+			const std::chrono::milliseconds &interval);
+	// the devices from first to last (exclusive) are controlled by the sleeping thread
+	bool sleepUntil(std::chrono::steady_clock::time_point deadline, std::size_t first, std::size_t last);
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_CONTROL_CONTROLLOOP_H_ */
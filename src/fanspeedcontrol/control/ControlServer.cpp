@@ -0,0 +1,403 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "ControlServer.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/metrics/Metrics.h"
+#include "fanspeedcontrol/metrics/MetricsServer.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+const int MAX_EVENTS = 16;
+const std::size_t MAX_CLIENTS = 64;
+// a client which sends longer lines or does not read its answers is disconnected
+const std::size_t MAX_REQUEST_LENGTH = 256;
+const std::size_t MAX_OUTPUT_LENGTH = 1 << 20;
+// an override ends at the latest after a day, so that a forgotten command does not pin a fan forever
+const long MAX_OVERRIDE_SECONDS = 24 * 60 * 60;
+// enough for the status of a device, so that the status is built without reallocations
+const std::size_t STATUS_LENGTH_PER_DEVICE = 192;
+
+const std::string COMMAND_STATUS = "status";
+const std::string COMMAND_PIN = "pin";
+const std::string COMMAND_AUTOMATIC = "automatic";
+const std::string COMMAND_RELEASE = "release";
+const std::string COMMAND_INTERVAL = "interval";
+
+const std::string ANSWER_OK = "{\"ok\":true}";
+
+std::string getErrorAnswer(const std::string &error) {
+	return "{\"ok\":false, \"error\":\"" + error + "\"}";
+}
+
+const char *getOverrideName(int override) {
+	switch (override) {
+	case AbstractDevice::OVERRIDE_FAN_SPEED:
+		return "fanSpeed";
+	case AbstractDevice::OVERRIDE_AUTOMATIC_MODE:
+		return "automaticMode";
+	default:
+		return "none";
+	}
+}
+
+// the whole word must be a decimal integer
+bool parseInteger(const std::string &word, long &value) {
+	if (word.empty()) {
+		return false;
+	}
+
+	char *end;
+	errno = 0;
+	value = std::strtol(word.c_str(), &end, 10);
+	return errno == 0 && *end == '\0';
+}
+
+std::unique_ptr<ControlServer> ControlServer::createUnixSocketServer(const std::string &path,
+		const std::vector<std::unique_ptr<AbstractDevice>> &devices, const std::shared_ptr<Metrics> &metrics) {
+	if (!metrics || metrics->getDeviceCount() != devices.size()) {
+		return std::unique_ptr<ControlServer>();
+	}
+
+	int listenFd = listenOnUnixSocket(path, true);
+	if (listenFd < 0) {
+		return std::unique_ptr<ControlServer>();
+	}
+
+	int epollFd = epoll_create1(EPOLL_CLOEXEC);
+	int stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+	epoll_event listenEvent = epoll_event();
+	listenEvent.events = EPOLLIN;
+	listenEvent.data.fd = listenFd;
+
+	epoll_event stopEvent = epoll_event();
+	stopEvent.events = EPOLLIN;
+	stopEvent.data.fd = stopFd;
+
+	if (epollFd < 0 || stopFd < 0
+			|| fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK) != 0
+			|| epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent) != 0
+			|| epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &stopEvent) != 0) {
+		for (int fd : {listenFd, epollFd, stopFd}) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+		unlink(path.c_str());
+		return std::unique_ptr<ControlServer>();
+	}
+
+	return std::unique_ptr<ControlServer>(new ControlServer(listenFd, epollFd, stopFd, path, devices, metrics));
+}
+
+ControlServer::ControlServer(int listenFd, int epollFd, int stopFd, const std::string &path,
+		const std::vector<std::unique_ptr<AbstractDevice>> &devices, const std::shared_ptr<Metrics> &metrics)
+: listenFd(listenFd), epollFd(epollFd), stopFd(stopFd), path(path), devices(devices), metrics(metrics) {
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		statusPrefixes.push_back("{\"index\":" + std::to_string(i) + ", \"type\":\"" + devices[i]->getType()
+				+ "\", \"id\":" + std::to_string(devices[i]->getId()) + ", \"temperature\":");
+	}
+
+	server = std::thread(&ControlServer::serve, this);
+}
+
+ControlServer::~ControlServer() {
+	std::uint64_t stop = 1;
+	while (write(stopFd, &stop, sizeof(stop)) < 0 && errno == EINTR) {
+	}
+	server.join();
+
+	close(listenFd);
+	close(epollFd);
+	close(stopFd);
+	unlink(path.c_str());
+}
+
+void ControlServer::serve() {
+	epoll_event events[MAX_EVENTS];
+
+	while (true) {
+		int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+		if (count < 0 && errno != EINTR) {
+			break;
+		}
+
+		bool stop = false;
+		for (int i = 0; i < count; ++i) {
+			int fd = events[i].data.fd;
+
+			if (fd == stopFd) {
+				stop = true;
+			} else if (fd == listenFd) {
+				acceptClients();
+			} else {
+				std::map<int, client>::iterator found = clients.find(fd);
+				if (found == clients.end()) {
+					continue;
+				}
+
+				bool open = (events[i].events & EPOLLIN) || !(events[i].events & (EPOLLHUP | EPOLLERR));
+				if (open && (events[i].events & EPOLLIN)) {
+					open = receive(fd, found->second);
+				}
+				if (open && (events[i].events & EPOLLOUT)) {
+					open = flush(fd, found->second);
+				}
+				if (!open) {
+					closeClient(fd);
+				}
+			}
+		}
+
+		if (stop) {
+			break;
+		}
+	}
+
+	while (!clients.empty()) {
+		closeClient(clients.begin()->first);
+	}
+}
+
+void ControlServer::acceptClients() {
+	while (true) {
+		int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+		if (clientFd < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return;
+		}
+
+		epoll_event event = epoll_event();
+		event.events = EPOLLIN;
+		event.data.fd = clientFd;
+
+		if (clients.size() >= MAX_CLIENTS || epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &event) != 0) {
+			close(clientFd);
+			continue;
+		}
+
+		clients[clientFd] = client();
+	}
+}
+
+bool ControlServer::receive(int clientFd, client &client) {
+	bool closed = false;
+	char buffer[1024];
+
+	while (true) {
+		ssize_t received = recv(clientFd, buffer, sizeof(buffer), MSG_DONTWAIT);
+		if (received < 0 && errno == EINTR) {
+			continue;
+		}
+		if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		if (received <= 0) {
+			// the requests before the end of the input are answered, e.g. if the client closed its side for writing
+			closed = true;
+			break;
+		}
+		client.input.append(buffer, received);
+	}
+
+	std::size_t begin = 0;
+	std::size_t end;
+	while ((end = client.input.find('\n', begin)) != std::string::npos) {
+		std::size_t length = end > begin && client.input[end - 1] == '\r' ? end - begin - 1 : end - begin;
+		client.output += answer(client.input.substr(begin, length));
+		client.output += '\n';
+		begin = end + 1;
+	}
+	client.input.erase(0, begin);
+
+	if (client.input.size() > MAX_REQUEST_LENGTH || client.output.size() > MAX_OUTPUT_LENGTH) {
+		return false;
+	}
+
+	return flush(clientFd, client) && !closed;
+}
+
+bool ControlServer::flush(int clientFd, client &client) {
+	std::size_t sent = 0;
+	while (sent < client.output.size()) {
+		ssize_t written = send(clientFd, client.output.data() + sent, client.output.size() - sent,
+				MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		if (written <= 0) {
+			return false;
+		}
+		sent += written;
+	}
+	client.output.erase(0, sent);
+
+	// the server waits for a writable socket only while an answer is pending
+	bool waitForOutput = !client.output.empty();
+	if (waitForOutput != client.waitingForOutput) {
+		epoll_event event = epoll_event();
+		event.events = waitForOutput ? EPOLLIN | EPOLLOUT : EPOLLIN;
+		event.data.fd = clientFd;
+		epoll_ctl(epollFd, EPOLL_CTL_MOD, clientFd, &event);
+		client.waitingForOutput = waitForOutput;
+	}
+
+	return true;
+}
+
+void ControlServer::closeClient(int clientFd) {
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, clientFd, nullptr);
+	close(clientFd);
+	clients.erase(clientFd);
+}
+
+std::string ControlServer::answer(const std::string &request) {
+	if (request == COMMAND_STATUS) {
+		return getStatus();
+	}
+
+	std::vector<std::string> words;
+	std::istringstream stream(request);
+	std::string word;
+	while (stream >> word) {
+		words.push_back(word);
+	}
+
+	if (words.empty()) {
+		return getErrorAnswer("empty request");
+	}
+
+	return executeCommand(request, words);
+}
+
+std::string ControlServer::getStatus() const {
+	std::string status;
+	status.reserve(STATUS_LENGTH_PER_DEVICE * statusPrefixes.size());
+	status += "{\"devices\":[";
+
+	for (std::size_t i = 0; i < statusPrefixes.size(); ++i) {
+		const DeviceMetrics &deviceMetrics = metrics->getDeviceMetrics(i);
+
+		if (i > 0) {
+			status += ", ";
+		}
+
+		status += statusPrefixes[i];
+		status += std::to_string(deviceMetrics.temperature.load(std::memory_order_relaxed));
+		status += ", \"fanSpeed\":";
+		status += std::to_string(deviceMetrics.fanSpeed.load(std::memory_order_relaxed));
+		status += ", \"automaticMode\":";
+		status += deviceMetrics.automaticMode.load(std::memory_order_relaxed) ? "true" : "false";
+		status += ", \"override\":\"";
+		status += getOverrideName(deviceMetrics.override.load(std::memory_order_relaxed));
+		status += "\", \"pollInterval\":";
+		status += std::to_string(deviceMetrics.pollIntervalMilliseconds.load(std::memory_order_relaxed));
+		status += "}";
+	}
+
+	status += "]}";
+	return status;
+}
+
+std::string ControlServer::executeCommand(const std::string &request, const std::vector<std::string> &words) {
+	const std::string &command = words[0];
+
+	std::size_t expectedWords;
+	if (command == COMMAND_PIN || command == COMMAND_INTERVAL) {
+		expectedWords = 4;
+	} else if (command == COMMAND_AUTOMATIC) {
+		expectedWords = 3;
+	} else if (command == COMMAND_RELEASE) {
+		expectedWords = 2;
+	} else {
+		return getErrorAnswer("unknown command");
+	}
+
+	std::vector<long> arguments;
+	for (std::size_t i = 1; i < words.size(); ++i) {
+		long argument;
+		if (!parseInteger(words[i], argument)) {
+			return getErrorAnswer("arguments must be integers");
+		}
+		arguments.push_back(argument);
+	}
+
+	if (words.size() != expectedWords) {
+		return getErrorAnswer("wrong number of arguments");
+	}
+
+	if (arguments[0] < 0 || static_cast<std::size_t>(arguments[0]) >= devices.size()) {
+		return getErrorAnswer("unknown device");
+	}
+
+	AbstractDevice &device = *devices[arguments[0]];
+	bool applied = false;
+
+	if (command == COMMAND_PIN) {
+		applied = arguments[1] >= MIN_FAN_SPEED && arguments[1] <= MAX_FAN_SPEED
+				&& arguments[2] > 0 && arguments[2] <= MAX_OVERRIDE_SECONDS && device.setOverride(
+						AbstractDevice::OVERRIDE_FAN_SPEED, arguments[1], std::chrono::seconds(arguments[2]));
+	} else if (command == COMMAND_AUTOMATIC) {
+		applied = arguments[1] > 0 && arguments[1] <= MAX_OVERRIDE_SECONDS && device.setOverride(
+				AbstractDevice::OVERRIDE_AUTOMATIC_MODE, -1, std::chrono::seconds(arguments[1]));
+	} else if (command == COMMAND_RELEASE) {
+		applied = device.setOverride(AbstractDevice::OVERRIDE_NONE, -1, std::chrono::milliseconds::zero());
+	} else {
+		std::chrono::milliseconds minInterval(arguments[1]);
+		std::chrono::milliseconds maxInterval(arguments[2]);
+		applied = device.updateParameters([&minInterval, &maxInterval](AbstractDevice::Parameters &changed) {
+			changed.minInterval = minInterval;
+			changed.maxInterval = maxInterval;
+		});
+	}
+
+	if (!applied) {
+		return getErrorAnswer("invalid value");
+	}
+
+	device.notifyObservers(AbstractDevice::CONTROL_COMMAND, device.to_string(), request);
+	return ANSWER_OK;
+}
+
+}
+}
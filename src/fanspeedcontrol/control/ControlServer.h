@@ -0,0 +1,92 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef FANSPEEDCONTROL_CONTROL_CONTROLSERVER_H_
+#define FANSPEEDCONTROL_CONTROL_CONTROLSERVER_H_
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "fanspeedcontrol/metrics/Metrics.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// serves the control socket with an epoll loop in its own thread, a client sends requests as lines
+// and gets a JSON object as line for every request, the requests are:
+// status, pin INDEX SPEED SECONDS, automatic INDEX SECONDS, release INDEX and interval INDEX MIN MAX,
+// the status is taken from the metrics of the last tick and the commands publish new parameters of the device,
+// so that a request never touches the hardware and never waits for the control of a device
+class ControlServer {
+public:
+	// only the user of fanspeedcontrol can connect to the socket,
+	// returns an empty pointer if the socket cannot be created
+	static std::unique_ptr<ControlServer> createUnixSocketServer(const std::string &path,
+			const std::vector<std::unique_ptr<AbstractDevice>> &devices, const std::shared_ptr<Metrics> &metrics);
+
+	virtual ~ControlServer();
+
+	ControlServer(const ControlServer &) = delete;
+	ControlServer &operator=(const ControlServer &) = delete;
+
+	// answer of a single request line without the line break, also used by the benchmarks
+	std::string answer(const std::string &request);
+
+private:
+	struct client {
+		std::string input;
+		std::string output;
+		bool waitingForOutput = false;
+	};
+
+	ControlServer(int listenFd, int epollFd, int stopFd, const std::string &path,
+			const std::vector<std::unique_ptr<AbstractDevice>> &devices, const std::shared_ptr<Metrics> &metrics);
+
+	const int listenFd;
+	const int epollFd;
+	// eventfd, which wakes up the server thread to stop it
+	const int stopFd;
+	const std::string path;
+	const std::vector<std::unique_ptr<AbstractDevice>> &devices;
+	const std::shared_ptr<Metrics> metrics;
+	// beginning of the status of every device, rendered once
+	std::vector<std::string> statusPrefixes;
+
+	// only used by the server thread
+	std::map<int, client> clients;
+	std::thread server;
+
+	void serve();
+	void acceptClients();
+	bool receive(int clientFd, client &client);
+	bool flush(int clientFd, client &client);
+	void closeClient(int clientFd);
+
+	std::string getStatus() const;
+	std::string executeCommand(const std::string &request, const std::vector<std::string> &words);
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_CONTROL_CONTROLSERVER_H_ */
@@ -0,0 +1,83 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "FeedForward.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include <libintl.h>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+bool FeedForward::parameters::operator==(const parameters &other) const {
+	return gain == other.gain && timeConstant == other.timeConstant;
+}
+
+FeedForward::FeedForward(const parameters &feedForwardParameters)
+: feedForwardParameters(feedForwardParameters) {
+}
+
+FeedForward::~FeedForward() {
+}
+
+double FeedForward::update(int load, double seconds) {
+	if (load < 0) {
+		started = false;
+		return 0;
+	}
+
+	// the average starts at the first load, so that the term does not ramp up the fan at the start
+	if (!started) {
+		started = true;
+		averageLoad = load;
+		return 0;
+	}
+
+	if (seconds > 0) {
+		averageLoad += seconds / (feedForwardParameters.timeConstant + seconds) * (load - averageLoad);
+	}
+
+	// only ahead of rising temperatures, a falling load is followed by the temperature
+	return std::max(feedForwardParameters.gain * (load - averageLoad), 0.0);
+}
+
+void FeedForward::checkAttributes(InvalidAttributes &invalidAttributes) const {
+	if (feedForwardParameters.gain < 0) {
+		invalidAttributes.push_back({"feedForward", gettext("must not be negative")});
+	}
+
+	if (feedForwardParameters.timeConstant < 0) {
+		invalidAttributes.push_back({"feedForwardTime", gettext("must not be negative")});
+	}
+}
+
+std::string FeedForward::to_string() const {
+	std::stringstream s;
+	s << "\"feedForward\":" << feedForwardParameters.gain << ", \"feedForwardTime\":"
+			<< feedForwardParameters.timeConstant;
+	return s.str();
+}
+
+const FeedForward::parameters &FeedForward::getParameters() const {
+	return feedForwardParameters;
+}
+
+}
+}
@@ -0,0 +1,63 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_CONTROL_FEEDFORWARD_H_
+#define FANSPEEDCONTROL_CONTROL_FEEDFORWARD_H_
+
+#include <string>
+
+#include "fanspeedcontrol/devices/InvalidAttribute.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// lead term from the load of the device (e.g. utilization), which rises before the temperature:
+// the fan speed is increased by gain percent per percent of load above the load averaged over timeConstant,
+// so the term ramps up the fan when the load rises and decays when the temperature has caught up
+class FeedForward {
+public:
+	struct parameters {
+		// fan speed in percent per load in percent
+		double gain;
+		// time constant in seconds, should be about the delay of the temperature after a load change
+		double timeConstant;
+
+		bool operator==(const parameters &other) const;
+	};
+
+	FeedForward(const parameters &feedForwardParameters);
+	virtual ~FeedForward();
+
+	// returns the additional fan speed, 0 if the load is unknown (negative)
+	double update(int load, double seconds);
+
+	// adds every parameter, which is not valid, with the attribute of the configuration file
+	void checkAttributes(InvalidAttributes &invalidAttributes) const;
+	std::string to_string() const;
+	const parameters &getParameters() const;
+
+private:
+	const parameters feedForwardParameters;
+
+	bool started = false;
+	double averageLoad = 0;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_CONTROL_FEEDFORWARD_H_ */
@@ -0,0 +1,124 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "PidController.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include <libintl.h>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+bool PidController::parameters::operator==(const parameters &other) const {
+	return target == other.target && kp == other.kp && ki == other.ki && kd == other.kd
+			&& minOutput == other.minOutput && maxOutput == other.maxOutput && derivativeFilter == other.derivativeFilter;
+}
+
+PidController::PidController(const parameters &pidParameters)
+: pidParameters(pidParameters) {
+}
+
+PidController::~PidController() {
+}
+
+void PidController::reset(double temperature, double output) {
+	started = true;
+	lastTemperature = temperature;
+	derivative = 0;
+	// the integral takes the part of the output which is not explained by the proportional part
+	integral = clamp(output) - pidParameters.kp * (temperature - pidParameters.target);
+}
+
+bool PidController::isStarted() const {
+	return started;
+}
+
+void PidController::stop() {
+	started = false;
+}
+
+double PidController::update(double temperature, double seconds) {
+	if (!started) {
+		reset(temperature, pidParameters.minOutput);
+	}
+
+	double error = temperature - pidParameters.target;
+
+	if (seconds > 0) {
+		double rawDerivative = (temperature - lastTemperature) / seconds;
+		double alpha = seconds / (pidParameters.derivativeFilter + seconds);
+		derivative += alpha * (rawDerivative - derivative);
+	}
+	lastTemperature = temperature;
+
+	double proportional = pidParameters.kp * error;
+	double differential = pidParameters.kd * derivative;
+	double newIntegral = integral + pidParameters.ki * error * std::max(seconds, 0.0);
+	double output = proportional + newIntegral + differential;
+
+	// integrate only if the output is not saturated or the error reduces the saturation
+	if ((output <= pidParameters.maxOutput || error < 0) && (output >= pidParameters.minOutput || error > 0)) {
+		integral = newIntegral;
+	}
+
+	return clamp(proportional + integral + differential);
+}
+
+void PidController::checkAttributes(InvalidAttributes &invalidAttributes) const {
+	if (pidParameters.kp < 0) {
+		invalidAttributes.push_back({"kp", gettext("must not be negative")});
+	}
+
+	if (pidParameters.ki < 0) {
+		invalidAttributes.push_back({"ki", gettext("must not be negative")});
+	}
+
+	if (pidParameters.kd < 0) {
+		invalidAttributes.push_back({"kd", gettext("must not be negative")});
+	}
+
+	if (pidParameters.minOutput > pidParameters.maxOutput) {
+		invalidAttributes.push_back({"minSpeed", gettext("must not be greater than maxSpeed")});
+	}
+
+	if (pidParameters.derivativeFilter < 0) {
+		invalidAttributes.push_back({"derivativeFilter", gettext("must not be negative")});
+	}
+}
+
+std::string PidController::to_string() const {
+	std::stringstream s;
+	s << "\"target\":" << pidParameters.target << ", \"kp\":" << pidParameters.kp << ", \"ki\":" << pidParameters.ki
+			<< ", \"kd\":" << pidParameters.kd << ", \"minSpeed\":" << pidParameters.minOutput
+			<< ", \"maxSpeed\":" << pidParameters.maxOutput << ", \"derivativeFilter\":"
+			<< pidParameters.derivativeFilter;
+	return s.str();
+}
+
+double PidController::clamp(double output) const {
+	return std::min(std::max(output, pidParameters.minOutput), pidParameters.maxOutput);
+}
+
+const PidController::parameters &PidController::getParameters() const {
+	return pidParameters;
+}
+
+}
+}
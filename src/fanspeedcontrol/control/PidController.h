@@ -0,0 +1,77 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_CONTROL_PIDCONTROLLER_H_
+#define FANSPEEDCONTROL_CONTROL_PIDCONTROLLER_H_
+
+#include <string>
+
+#include "fanspeedcontrol/devices/InvalidAttribute.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// pid controller, which computes the fan speed from the difference between temperature and target temperature,
+// the integral is frozen while the output is saturated (anti-windup),
+// the derivative is computed from the temperature instead of the error, so that a new target causes no jump,
+// and it is smoothed by a first order low pass filter with the time constant derivativeFilter
+class PidController {
+public:
+	struct parameters {
+		double target;
+		double kp;
+		double ki;
+		double kd;
+		double minOutput;
+		double maxOutput;
+		// time constant in seconds
+		double derivativeFilter;
+
+		bool operator==(const parameters &other) const;
+	};
+
+	PidController(const parameters &pidParameters);
+	virtual ~PidController();
+
+	// starts from the given output without a jump, e.g. the fan speed of the curve
+	void reset(double temperature, double output);
+	bool isStarted() const;
+	void stop();
+
+	// returns the output between minOutput and maxOutput
+	double update(double temperature, double seconds);
+
+	// adds every parameter, which is not valid, with the attribute of the configuration file
+	void checkAttributes(InvalidAttributes &invalidAttributes) const;
+	std::string to_string() const;
+	const parameters &getParameters() const;
+
+private:
+	const parameters pidParameters;
+
+	bool started = false;
+	double integral = 0;
+	double lastTemperature = 0;
+	double derivative = 0;
+
+	double clamp(double output) const;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_CONTROL_PIDCONTROLLER_H_ */
@@ -0,0 +1,60 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Scheduler.h"
+
+#include <chrono>
+#include <cstddef>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+bool Scheduler::entry::operator>(const entry &other) const {
+	if (deadline != other.deadline) {
+		return deadline > other.deadline;
+	}
+
+	// devices with the same deadline are processed in the order of the configuration
+	return index > other.index;
+}
+
+Scheduler::Scheduler() {
+}
+
+Scheduler::~Scheduler() {
+}
+
+void Scheduler::schedule(std::chrono::steady_clock::time_point deadline, std::size_t index) {
+	queue.push(entry{deadline, index});
+}
+
+const Scheduler::entry &Scheduler::next() const {
+	return queue.top();
+}
+
+Scheduler::entry Scheduler::pop() {
+	entry top = queue.top();
+	queue.pop();
+	return top;
+}
+
+bool Scheduler::empty() const {
+	return queue.empty();
+}
+
+}
+}
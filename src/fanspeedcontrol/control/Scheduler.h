@@ -0,0 +1,55 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_CONTROL_SCHEDULER_H_
+#define FANSPEEDCONTROL_CONTROL_SCHEDULER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// priority queue of deadlines, the entry with the earliest deadline is on top
+class Scheduler {
+public:
+	struct entry {
+		std::chrono::steady_clock::time_point deadline;
+		std::size_t index;
+
+		bool operator>(const entry &other) const;
+	};
+
+	Scheduler();
+	virtual ~Scheduler();
+
+	void schedule(std::chrono::steady_clock::time_point deadline, std::size_t index);
+	const entry &next() const;
+	entry pop();
+	bool empty() const;
+
+private:
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_CONTROL_SCHEDULER_H_ */
@@ -0,0 +1,268 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Watchdog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/format.hpp>
+#include <fcntl.h>
+#include <libintl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "fanspeedcontrol/config/ConfigLoader.h"
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "patterns/clock/Clock.h"
+#include "patterns/clock/SteadyClock.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// the watchdog checks the heartbeats at least every MIN_CHECK_INTERVAL and four times per timeout
+const std::chrono::milliseconds MIN_CHECK_INTERVAL(10);
+
+// times of the steady clock of a device
+struct Heartbeat {
+	// last control of the device or wake-up of the thread, which controls it
+	std::atomic<std::chrono::steady_clock::rep> alive;
+	// start of the running control of the device, 0 between the controls
+	std::atomic<std::chrono::steady_clock::rep> controlStart;
+};
+
+// shared by the control process and the watchdog process, every value is a lock free and therefore
+// address free atomic, so that it can be used by both processes, the page is followed by a heartbeat
+// of every device of the configuration
+struct WatchdogPage {
+	// set by the control process before it closes the pipe, after it has stopped the devices
+	std::atomic<bool> stopped;
+	std::atomic<std::size_t> deviceCount;
+
+	Heartbeat *getHeartbeats() {
+		return reinterpret_cast<Heartbeat *>(this + 1);
+	}
+};
+
+static_assert(sizeof(WatchdogPage) % alignof(Heartbeat) == 0, "the heartbeats must be aligned after the page");
+static_assert(std::atomic<std::chrono::steady_clock::rep>::is_always_lock_free,
+		"the heartbeats must be lock free to be shared between processes");
+
+std::unique_ptr<Watchdog> Watchdog::start(const FileConfiguration &configuration,
+		const std::chrono::milliseconds &timeout, const std::vector<int> &closedFds) {
+	const std::size_t capacity = configuration.devices.size();
+
+	void *memory = mmap(nullptr, getMappingSize(capacity), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+			-1, 0);
+	if (memory == MAP_FAILED) {
+		return std::unique_ptr<Watchdog>();
+	}
+	WatchdogPage *page = new (memory) WatchdogPage();
+	for (std::size_t i = 0; i < capacity; ++i) {
+		new (page->getHeartbeats() + i) Heartbeat();
+	}
+
+	// close on exec, so that a started application (e.g. the sound player) does not keep the write end open
+	int pipeFds[2];
+	if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+		munmap(memory, getMappingSize(capacity));
+		return std::unique_ptr<Watchdog>();
+	}
+
+	// the output would be written twice, if it was buffered during the fork
+	std::cout.flush();
+
+	pid_t controlPid = getpid();
+	pid_t watchdogPid = fork();
+
+	if (watchdogPid == 0) {
+		close(pipeFds[1]);
+		// e.g. a flock is released only when every copy of its file descriptor is closed
+		for (int fd : closedFds) {
+			close(fd);
+		}
+		watch(page, pipeFds[0], controlPid, configuration, timeout);
+	}
+
+	close(pipeFds[0]);
+
+	if (watchdogPid < 0) {
+		close(pipeFds[1]);
+		munmap(memory, getMappingSize(capacity));
+		return std::unique_ptr<Watchdog>();
+	}
+
+	return std::unique_ptr<Watchdog>(new Watchdog(page, capacity, pipeFds[1], watchdogPid));
+}
+
+Watchdog::Watchdog(WatchdogPage *page, std::size_t capacity, int pipeFd, pid_t watchdogPid)
+: page(page), capacity(capacity), pipeFd(pipeFd), watchdogPid(watchdogPid) {
+}
+
+Watchdog::~Watchdog() {
+	page->stopped.store(true, std::memory_order_release);
+	close(pipeFd);
+	waitpid(watchdogPid, nullptr, 0);
+	munmap(page, getMappingSize(capacity));
+}
+
+bool Watchdog::watchDevices(std::size_t deviceCount) {
+	if (deviceCount > capacity) {
+		page->deviceCount.store(0, std::memory_order_release);
+		return false;
+	}
+
+	std::chrono::steady_clock::rep now = std::chrono::steady_clock::now().time_since_epoch().count();
+	for (std::size_t i = 0; i < deviceCount; ++i) {
+		page->getHeartbeats()[i].alive.store(now, std::memory_order_relaxed);
+	}
+
+	page->deviceCount.store(deviceCount, std::memory_order_release);
+	return true;
+}
+
+void Watchdog::startControl(std::size_t index) {
+	if (index < capacity) {
+		page->getHeartbeats()[index].controlStart.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+				std::memory_order_relaxed);
+	}
+}
+
+void Watchdog::endControl(std::size_t index) {
+	if (index < capacity) {
+		// released with the end of the control, so that the watchdog sees the new heartbeat after the end
+		beat(index);
+		page->getHeartbeats()[index].controlStart.store(0, std::memory_order_release);
+	}
+}
+
+void Watchdog::beat(std::size_t index) {
+	if (index < capacity) {
+		page->getHeartbeats()[index].alive.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+				std::memory_order_relaxed);
+	}
+}
+
+std::size_t Watchdog::getMappingSize(std::size_t capacity) {
+	return sizeof(WatchdogPage) + capacity * sizeof(Heartbeat);
+}
+
+void Watchdog::watch(WatchdogPage *page, int pipeFd, pid_t controlPid, const FileConfiguration &configuration,
+		const std::chrono::milliseconds &timeout) {
+	// the signals of a terminal or a service manager are handled by the control process, which stops the watchdog
+	std::signal(SIGINT, SIG_IGN);
+	std::signal(SIGTERM, SIG_IGN);
+	std::signal(SIGHUP, SIG_IGN);
+	std::signal(SIGUSR1, SIG_IGN);
+
+	const int checkInterval = std::max(timeout / 4, MIN_CHECK_INTERVAL).count();
+	const std::chrono::steady_clock::rep maxAge = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			timeout).count();
+
+	while (true) {
+		pollfd pipePoll = pollfd();
+		pipePoll.fd = pipeFd;
+		pipePoll.events = POLLIN;
+
+		// nothing is written into the pipe, so it is only readable at its end, when the control process terminated
+		if (poll(&pipePoll, 1, checkInterval) > 0) {
+			if (page->stopped.load(std::memory_order_acquire)) {
+				_exit(EXIT_SUCCESS);
+			}
+
+			std::cout << boost::format(gettext("The control process with the process id %d terminated without "
+					"stopping its devices.")) % controlPid << std::endl;
+			break;
+		}
+
+		std::size_t deviceCount = page->deviceCount.load(std::memory_order_acquire);
+		std::chrono::steady_clock::rep now = std::chrono::steady_clock::now().time_since_epoch().count();
+
+		// a hanging control is searched first, because it stops the heartbeats of the other devices of its thread
+		std::size_t stalled = findStalledDevice(page, deviceCount, now, maxAge, true);
+		if (stalled == deviceCount) {
+			stalled = findStalledDevice(page, deviceCount, now, maxAge, false);
+		}
+
+		if (stalled < deviceCount) {
+			// the control process is terminated, so that it does not set the fan speed again after a hanging call
+			std::cout << boost::format(gettext("The device at position %d was not controlled for %d milliseconds, "
+					"the control process with the process id %d is killed.")) % stalled % timeout.count() % controlPid
+					<< std::endl;
+			kill(controlPid, SIGKILL);
+			break;
+		}
+	}
+
+	setDevicesFailSafe(configuration);
+	_exit(EXIT_SUCCESS);
+}
+
+std::size_t Watchdog::findStalledDevice(WatchdogPage *page, std::size_t deviceCount,
+		std::chrono::steady_clock::rep now, std::chrono::steady_clock::rep maxAge, bool running) {
+	std::size_t index = 0;
+	for (; index < deviceCount; ++index) {
+		const Heartbeat &heartbeat = page->getHeartbeats()[index];
+		// acquired before the heartbeat, which is written before the end of the control
+		std::chrono::steady_clock::rep controlStart = heartbeat.controlStart.load(std::memory_order_acquire);
+
+		if (running ? controlStart != 0 && now - controlStart > maxAge
+				: controlStart == 0 && now - heartbeat.alive.load(std::memory_order_relaxed) > maxAge) {
+			break;
+		}
+	}
+	return index;
+}
+
+void Watchdog::setDevicesFailSafe(const FileConfiguration &configuration) {
+	std::shared_ptr<msc42::patterns::Clock> clock = std::make_shared<msc42::patterns::SteadyClock>();
+
+	// the devices are not checked, a device which cannot be opened anymore reports it with setFailSafeMode,
+	// the sensors are not opened, because the temperatures are not needed
+	for (const DeviceConfiguration &deviceConfiguration : configuration.devices) {
+		std::unique_ptr<AbstractDevice> device = createDevice(deviceConfiguration,
+				std::shared_ptr<SensorSnapshot>());
+		device->setClock(clock);
+
+		if (!device->setFailSafeMode()) {
+			std::cout << boost::format(gettext("The watchdog cannot set %s to automatic mode "
+					"or to the maximal fan speed.")) % device->to_string() << std::endl;
+		} else if (device->isAutomaticMode()) {
+			std::cout << boost::format(gettext("The watchdog set %s to automatic mode.")) % device->to_string()
+					<< std::endl;
+		} else {
+			std::cout << boost::format(gettext("The watchdog set %s to the maximal fan speed.")) % device->to_string()
+					<< std::endl;
+		}
+	}
+}
+
+}
+}
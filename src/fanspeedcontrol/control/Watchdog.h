@@ -0,0 +1,93 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef FANSPEEDCONTROL_CONTROL_WATCHDOG_H_
+#define FANSPEEDCONTROL_CONTROL_WATCHDOG_H_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+struct FileConfiguration;
+struct WatchdogPage;
+
+// fail-safe for the devices if the control process terminates without stopping them (SIGKILL, crash)
+// or if a device is not controlled anymore (e.g. a hanging driver call): a forked watchdog process watches
+// a heartbeat of every device in shared memory and a pipe, which is closed when the control process
+// terminates, then it opens the devices of the configuration again and sets them to automatic mode
+// or, if this is not possible, to the maximal fan speed, the heartbeat is written independently of the polling
+// interval, so that a device hangs only if a control takes too long or its thread does not wake up anymore
+class Watchdog {
+public:
+	// must be called before a device is opened, because the watchdog process opens its own devices,
+	// it keeps the parsed configuration, so that a later change of the configuration file does not matter,
+	// the watchdog process closes the file descriptors closedFds (e.g. of a lock of the control process),
+	// returns an empty pointer if the watchdog process cannot be started,
+	// returns only in the control process
+	static std::unique_ptr<Watchdog> start(const FileConfiguration &configuration,
+			const std::chrono::milliseconds &timeout, const std::vector<int> &closedFds);
+
+	// the watchdog process terminates without changing the devices,
+	// therefore the devices must be stopped before
+	virtual ~Watchdog();
+
+	Watchdog(const Watchdog &) = delete;
+	Watchdog &operator=(const Watchdog &) = delete;
+
+	// starts the watch of the heartbeats of the first deviceCount devices, 0 ends it, e.g. before the devices
+	// are stopped, the termination of the control process is always watched, returns false and watches no device
+	// if deviceCount is greater than the number of devices of the configuration
+	bool watchDevices(std::size_t deviceCount);
+	// called before every control of the device, a single atomic store
+	void startControl(std::size_t index);
+	// called after every control of the device
+	void endControl(std::size_t index);
+	// called every time the thread, which controls the device, wakes up, a single atomic store
+	void beat(std::size_t index);
+
+private:
+	Watchdog(WatchdogPage *page, std::size_t capacity, int pipeFd, pid_t watchdogPid);
+
+	WatchdogPage *const page;
+	// number of heartbeats after the page header
+	const std::size_t capacity;
+	// write end of the pipe, the watchdog process reads the end of the file when the control process terminates
+	const int pipeFd;
+	const pid_t watchdogPid;
+
+	static std::size_t getMappingSize(std::size_t capacity);
+
+	[[noreturn]] static void watch(WatchdogPage *page, int pipeFd, pid_t controlPid,
+			const FileConfiguration &configuration, const std::chrono::milliseconds &timeout);
+	// returns the first device, whose running control (running) or whose heartbeat between the controls
+	// (not running) is older than maxAge, or deviceCount
+	static std::size_t findStalledDevice(WatchdogPage *page, std::size_t deviceCount,
+			std::chrono::steady_clock::rep now, std::chrono::steady_clock::rep maxAge, bool running);
+	static void setDevicesFailSafe(const FileConfiguration &configuration);
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_CONTROL_WATCHDOG_H_ */
@@ -17,84 +17,433 @@
 
 #include "AbstractDevice.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <boost/format.hpp>
 #include <libintl.h>
 
+#include "fanspeedcontrol/sensors/SensorAggregation.h"
+#include "patterns/clock/Clock.h"
+#include "patterns/clock/SteadyClock.h"
+#include "patterns/observer/Event.h"
+
 namespace msc42 {
 namespace fanspeedcontrol {
 
-const int MIN_TEMPERATURE_VALID = 0;
-const int MAX_TEMPERATURE_VALID = 120;
 const int MAX_HYSTERESIS_VALID = 60;
 
+// temperatures within this distance of a breakpoint of the curve are polled with the minimal interval
+const int BREAKPOINT_DISTANCE = 2;
+
+const char *getInterpolationName(AbstractDevice::Interpolation interpolation) {
+	switch (interpolation) {
+	case AbstractDevice::INTERPOLATION_LINEAR:
+		return "linear";
+	case AbstractDevice::INTERPOLATION_MONOTONE_CUBIC:
+		return "cubic";
+	default:
+		return "step";
+	}
+}
+
 AbstractDevice::AbstractDevice(const std::string &typeString, int id,
 		int hysteresis, int warn, const std::map<int, int> &pairs)
-: typeString(typeString), id(id), hysteresis(hysteresis), warn(warn), pairs(pairs) {
+: typeString(typeString), id(id), parameters(createParameters(hysteresis, warn, pairs)),
+  clock(std::make_shared<msc42::patterns::SteadyClock>()) {
+	eventTemplate = msc42::patterns::Event();
+	std::strncpy(eventTemplate.sourceType, typeString.c_str(), msc42::patterns::Event::MAX_SOURCE_TYPE_LENGTH);
+	eventTemplate.sourceId = id;
+	eventTemplate.sourceIndex = 0;
 }
 
 AbstractDevice::~AbstractDevice() {
 }
 
+std::unique_ptr<const AbstractDevice::Parameters> AbstractDevice::createParameters(int hysteresis, int warn,
+		const std::map<int, int> &pairs) {
+	std::unique_ptr<Parameters> created(new Parameters());
+	created->hysteresis = hysteresis;
+	created->warn = warn;
+	created->pairs = pairs;
+	compileFanSpeedTables(*created);
+	return created;
+}
+
 void AbstractDevice::setOptimalFanSpeed() {
-	int temperature = getTemperature();
+	const Parameters &current = parameters.read();
+	if (current.version != appliedVersion) {
+		applyParameters(current);
+	}
+
+	controlFanSpeed(current);
+
+	// no reference to the parameters is held between two calls
+	parameters.quiescent();
+}
+
+void AbstractDevice::controlFanSpeed(const Parameters &current) {
+	std::chrono::steady_clock::time_point start = clock->now();
+	int temperature = current.temperatureSource ? current.temperatureSource->getTemperature(temperatureAverage)
+			: getTemperature();
+	int load = feedForward ? getLoad() : -1;
+	std::chrono::steady_clock::time_point read = clock->now();
+
+	lastPhaseDurations.read = read - start;
+	lastPhaseDurations.compute = std::chrono::steady_clock::duration::zero();
+	lastPhaseDurations.write = std::chrono::steady_clock::duration::zero();
+
+	adaptPollInterval(current, temperature);
+
 	if (temperature < MIN_TEMPERATURE_VALID || temperature > MAX_TEMPERATURE_VALID) {
-		notifyObservers(TEMPERATUR_READ_ERROR, to_string());
-		if (automaticMode || setAutomaticMode()) {
-			currentFanSpeed = -1;
-			automaticMode = true;
-			notifyObservers(MODE_AUTOMATIC_SET, to_string());
-			return;
-		} else {
-			notifyObservers(MODE_AUTOMATIC_SET_ERROR, to_string());
-			return;
+		notifyObservers(createEvent(TEMPERATUR_READ_ERROR, temperature));
+
+		// the controller starts again from the curve with the next valid temperature
+		if (controller) {
+			controller->stop();
 		}
+
+		switchToAutomaticMode(temperature);
+
+		lastPhaseDurations.write = clock->now() - read;
+		return;
 	}
 
-	if (temperature >= warn) {
-		notifyObservers(TEMPERATURE_WARN, to_string(), std::to_string(temperature));
+	if (temperature >= current.warn) {
+		notifyObservers(createEvent(TEMPERATURE_WARN, temperature));
+	}
+
+	// from the warn temperature on the fan is controlled even if an override is set
+	activeOverride = current.override != OVERRIDE_NONE && read < current.overrideEnd && temperature < current.warn
+			? current.override : OVERRIDE_NONE;
+
+	if (activeOverride != OVERRIDE_NONE && controller) {
+		// the controller starts again from the curve when the override ends
+		controller->stop();
+	}
+
+	if (activeOverride == OVERRIDE_AUTOMATIC_MODE) {
+		if (!automaticMode) {
+			switchToAutomaticMode(temperature);
+		}
+
+		lastPhaseDurations.write = clock->now() - read;
+		return;
 	}
 
-	int optimalFanSpeed = calculateOptimalFanSpeed(temperature);
+	int optimalFanSpeed;
+	if (activeOverride == OVERRIDE_FAN_SPEED) {
+		optimalFanSpeed = current.overrideFanSpeed;
+	} else {
+		optimalFanSpeed = calculateOptimalFanSpeed(current, temperature);
+		if (controller) {
+			optimalFanSpeed = getControlledFanSpeed(current, temperature, optimalFanSpeed);
+		}
+		if (feedForward) {
+			optimalFanSpeed = getFedForwardFanSpeed(load, optimalFanSpeed, read);
+		}
+	}
+	std::chrono::steady_clock::time_point computed = clock->now();
+	lastPhaseDurations.compute = computed - read;
+
 	if (currentFanSpeed != optimalFanSpeed) {
-		if (setManualMode()) {
+		// a fan speed set by an override is always written
+		if (activeOverride == OVERRIDE_NONE
+				&& !isFanSpeedWriteNeeded(current, optimalFanSpeed, temperature, computed)) {
+			countAvoidedWrite();
+			return;
+		}
+
+		// the manual mode is set only on the transition, it stays set until the automatic mode is set or a write fails
+		if (manualMode) {
+			countAvoidedWrite();
+		} else if (setManualMode()) {
 			automaticMode = false;
+			manualMode = true;
 			manualModeWasSetAtLeastOnce = true;
 		} else {
-			notifyObservers(MODE_MANUAL_SET_ERROR, to_string());
+			notifyObservers(createEvent(MODE_MANUAL_SET_ERROR, temperature));
 		}
 
 		if (setFanSpeed(optimalFanSpeed)) {
 			currentFanSpeed = optimalFanSpeed;
+			lastFanSpeedWrite = computed;
 			manualModeWasSetAtLeastOnce = true;
-			notifyObservers(FAN_SET, to_string(), std::to_string(currentFanSpeed));
+			notifyObservers(createEvent(FAN_SET, temperature));
 		} else {
-			notifyObservers(FAN_SET_ERROR, to_string());
-			if (automaticMode || setAutomaticMode()) {
-				currentFanSpeed = -1;
-				automaticMode = true;
-				notifyObservers(MODE_AUTOMATIC_SET, to_string());
-			} else {
-				notifyObservers(MODE_AUTOMATIC_SET_ERROR, to_string());
-			}
+			notifyObservers(createEvent(FAN_SET_ERROR, temperature));
+			switchToAutomaticMode(temperature);
 		}
+
+		lastPhaseDurations.write = clock->now() - computed;
 	}
 }
 
+void AbstractDevice::switchToAutomaticMode(int temperature) {
+	manualMode = false;
+	if (automaticMode || setAutomaticMode()) {
+		currentFanSpeed = -1;
+		automaticMode = true;
+		notifyObservers(createEvent(MODE_AUTOMATIC_SET, temperature));
+	} else {
+		notifyObservers(createEvent(MODE_AUTOMATIC_SET_ERROR, temperature));
+	}
+}
+
+bool AbstractDevice::isFanSpeedWriteNeeded(const Parameters &current, int optimalFanSpeed, int currentTemperature,
+		std::chrono::steady_clock::time_point now) const {
+	// the first write in manual mode, the limits of the fan speed and writes from the warn temperature on are
+	// never suppressed
+	if (currentFanSpeed < 0 || optimalFanSpeed == MIN_FAN_SPEED || optimalFanSpeed == MAX_FAN_SPEED
+			|| currentTemperature >= current.warn) {
+		return true;
+	}
+
+	if (std::abs(optimalFanSpeed - currentFanSpeed) < current.minFanSpeedDelta) {
+		return false;
+	}
+
+	// only a decrease waits for the dwell time, so that the fan follows a rising temperature immediately
+	return optimalFanSpeed > currentFanSpeed || now - lastFanSpeedWrite >= current.minFanSpeedDwell;
+}
+
+void AbstractDevice::setPollIntervals(const std::chrono::milliseconds &minInterval,
+		const std::chrono::milliseconds &maxInterval) {
+	changeParameters([&minInterval, &maxInterval](Parameters &changed) {
+		changed.minInterval = minInterval;
+		changed.maxInterval = maxInterval;
+	});
+}
+
+std::chrono::milliseconds AbstractDevice::getPollInterval() const {
+	return pollInterval;
+}
+
+void AbstractDevice::adaptPollInterval(const Parameters &current, int currentTemperature) {
+	bool isTemperatureValid = currentTemperature >= MIN_TEMPERATURE_VALID
+			&& currentTemperature <= MAX_TEMPERATURE_VALID;
+
+	// the interval halves back to the minimal interval, so that a single reading near a breakpoint
+	// does not undo the doubling of several stable readings
+	if (!isTemperatureValid || currentTemperature > lastTemperature || isNearBreakpoint(current, currentTemperature)) {
+		pollInterval = std::min(std::max(pollInterval / 2, current.minInterval), current.maxInterval);
+	} else {
+		pollInterval = std::min(pollInterval * 2, current.maxInterval);
+	}
+
+	lastTemperature = currentTemperature;
+}
+
+bool AbstractDevice::isNearBreakpoint(const Parameters &current, int currentTemperature) const {
+	for (const std::pair<const int, int>& kv : current.pairs) {
+		if (std::abs(currentTemperature - kv.first) <= BREAKPOINT_DISTANCE
+				|| std::abs(currentTemperature - (kv.first - current.hysteresis)) <= BREAKPOINT_DISTANCE) {
+			return true;
+		}
+	}
+
+	return current.warn - currentTemperature <= BREAKPOINT_DISTANCE;
+}
+
+void AbstractDevice::setIndex(int index) {
+	eventTemplate.sourceIndex = index;
+}
+
+void AbstractDevice::setClock(const std::shared_ptr<msc42::patterns::Clock> &clock) {
+	this->clock = clock;
+}
+
+void AbstractDevice::setController(const PidController::parameters &pidParameters) {
+	changeParameters([&pidParameters](Parameters &changed) {
+		changed.controller = pidParameters;
+	});
+}
+
+void AbstractDevice::setWriteCoalescing(int minFanSpeedDelta, const std::chrono::milliseconds &minFanSpeedDwell) {
+	changeParameters([minFanSpeedDelta, &minFanSpeedDwell](Parameters &changed) {
+		changed.minFanSpeedDelta = minFanSpeedDelta;
+		changed.minFanSpeedDwell = minFanSpeedDwell;
+	});
+}
+
+void AbstractDevice::setParameters(const std::function<void(Parameters &)> &change) {
+	changeParameters(change);
+}
+
+void AbstractDevice::checkChangedParameters(const std::function<void(Parameters &)> &change,
+		InvalidAttributes &invalidAttributes) const {
+	Parameters changed = getParameters();
+	change(changed);
+	compileFanSpeedTables(changed);
+	checkParameters(changed, invalidAttributes);
+}
+
+bool AbstractDevice::setOverride(Override override, int fanSpeed, const std::chrono::milliseconds &duration) {
+	std::chrono::steady_clock::time_point end = clock->now() + duration;
+
+	return updateParameters([override, fanSpeed, end](Parameters &changed) {
+		changed.override = override;
+		changed.overrideFanSpeed = override == OVERRIDE_FAN_SPEED ? fanSpeed : -1;
+		changed.overrideEnd = end;
+	});
+}
+
+bool AbstractDevice::updateParameters(const std::function<void(Parameters &)> &update) {
+	return parameters.update([&update](Parameters &changed) {
+		update(changed);
+		compileFanSpeedTables(changed);
+		++changed.version;
+
+		InvalidAttributes invalidAttributes;
+		checkParameters(changed, invalidAttributes);
+		return invalidAttributes.empty();
+	});
+}
+
+void AbstractDevice::changeParameters(const std::function<void(Parameters &)> &change) {
+	parameters.update([&change](Parameters &changed) {
+		change(changed);
+		compileFanSpeedTables(changed);
+		++changed.version;
+		return true;
+	});
+}
+
+AbstractDevice::Parameters AbstractDevice::getParameters() const {
+	return parameters.copy();
+}
+
+void AbstractDevice::applyParameters(const Parameters &current) {
+	// the controller, the feed-forward and the aggregation keep their state if their parameters are unchanged
+	if (!current.controller) {
+		controller.reset();
+	} else if (!controller || !(controller->getParameters() == *current.controller)) {
+		controller.reset(new PidController(*current.controller));
+	}
+
+	if (!current.feedForward) {
+		feedForward.reset();
+	} else if (!feedForward || !(feedForward->getParameters() == *current.feedForward)) {
+		feedForward.reset(new FeedForward(*current.feedForward));
+	}
+
+	if (current.temperatureSource != averagedTemperatureSource) {
+		averagedTemperatureSource = current.temperatureSource;
+		temperatureAverage = SensorAggregation::Average();
+	}
+
+	pollInterval = std::min(std::max(pollInterval, current.minInterval), current.maxInterval);
+	appliedVersion = current.version;
+}
+
+void AbstractDevice::setFeedForward(const FeedForward::parameters &feedForwardParameters) {
+	changeParameters([&feedForwardParameters](Parameters &changed) {
+		changed.feedForward = feedForwardParameters;
+	});
+}
+
+int AbstractDevice::getLoad() {
+	return -1;
+}
+
+const std::string &AbstractDevice::getType() const {
+	return typeString;
+}
+
+int AbstractDevice::getId() const {
+	return id;
+}
+
+int AbstractDevice::getLastTemperature() const {
+	return lastTemperature;
+}
+
+int AbstractDevice::getCurrentFanSpeed() const {
+	return currentFanSpeed;
+}
+
+bool AbstractDevice::isAutomaticMode() const {
+	return automaticMode;
+}
+
+bool AbstractDevice::setFailSafeMode() {
+	if (setAutomaticMode()) {
+		automaticMode = true;
+		manualMode = false;
+		currentFanSpeed = -1;
+		return true;
+	}
+
+	if (setManualMode() && setFanSpeed(MAX_FAN_SPEED)) {
+		automaticMode = false;
+		manualMode = true;
+		currentFanSpeed = MAX_FAN_SPEED;
+		return true;
+	}
+
+	return false;
+}
+
+AbstractDevice::Override AbstractDevice::getActiveOverride() const {
+	return activeOverride;
+}
+
+unsigned long AbstractDevice::getAvoidedWrites() const {
+	return avoidedWrites.load(std::memory_order_relaxed);
+}
+
+void AbstractDevice::countAvoidedWrite() {
+	// a load and a store instead of a locked increment, there is only one writer
+	avoidedWrites.store(avoidedWrites.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+const AbstractDevice::PhaseDurations &AbstractDevice::getLastPhaseDurations() const {
+	return lastPhaseDurations;
+}
+
+msc42::patterns::Event AbstractDevice::createEvent(int messageId, int temperature) const {
+	msc42::patterns::Event event = eventTemplate;
+	event.messageId = messageId;
+	event.temperature = temperature;
+	event.fanSpeed = currentFanSpeed;
+	event.timestamp = clock->now();
+	return event;
+}
+
+std::string AbstractDevice::to_string(const msc42::patterns::Event &event) {
+	std::stringstream s;
+	s << "{\"type\":\"" << event.sourceType << "\", \"id\":" << event.sourceId << "}";
+	return s.str();
+}
+
 std::string AbstractDevice::to_string(bool verbose) const {
 	std::stringstream s;
 	s << "{\"type\":\"" << typeString << "\", \"id\":" << id;
 
 	if (verbose) {
-		s << ", \"hysteresis\":" << hysteresis << ", \"warn\":" << warn << ", ";
+		Parameters current = getParameters();
+
+		s << ", \"hysteresis\":" << current.hysteresis << ", \"warn\":" << current.warn
+				<< ", \"minInterval\":" << current.minInterval.count()
+				<< ", \"maxInterval\":" << current.maxInterval.count()
+				<< ", \"interpolation\":\"" << getInterpolationName(current.interpolation) << "\", ";
 
 		bool notFirstElement = false;
-		for (std::pair<const int, int> pair : pairs) {
+		for (std::pair<const int, int> pair : current.pairs) {
 			if (notFirstElement) {
 				s << ", ";
 			} else {
@@ -103,6 +452,23 @@ std::string AbstractDevice::to_string(bool verbose) const {
 
 			s << "\"" << pair.first << "\":" << pair.second;
 		}
+
+		if (current.temperatureSource) {
+			s << ", \"sensors\":" << current.temperatureSource->to_string();
+		}
+
+		if (current.controller) {
+			s << ", \"controller\":\"pid\", " << PidController(*current.controller).to_string();
+		}
+
+		if (current.feedForward) {
+			s << ", " << FeedForward(*current.feedForward).to_string();
+		}
+
+		if (current.minFanSpeedDelta > 0 || current.minFanSpeedDwell > std::chrono::milliseconds::zero()) {
+			s << ", \"writeMinDelta\":" << current.minFanSpeedDelta
+					<< ", \"writeMinDwell\":" << current.minFanSpeedDwell.count();
+		}
 	}
 
 	s << "}";
@@ -110,49 +476,273 @@ std::string AbstractDevice::to_string(bool verbose) const {
 	return s.str();
 }
 
-int AbstractDevice::getFanSpeed(int currentTemperature, int hysteresis) const {
-	for (const std::pair<const int, int>& kv : pairs) {
+int AbstractDevice::getControlledFanSpeed(const Parameters &current, int currentTemperature, int curveFanSpeed) {
+	std::chrono::steady_clock::time_point now = clock->now();
+
+	// the curve is used until the controller is started, the controller continues with its fan speed without a jump
+	if (!controller->isStarted()) {
+		controller->reset(currentTemperature, curveFanSpeed);
+		lastControllerUpdate = now;
+		return curveFanSpeed;
+	}
+
+	double seconds = std::chrono::duration<double>(now - lastControllerUpdate).count();
+	lastControllerUpdate = now;
+
+	int fanSpeed = static_cast<int>(std::lround(controller->update(currentTemperature, seconds)));
+
+	// from the warn temperature on the fan runs at least with the speed of the curve
+	if (currentTemperature >= current.warn) {
+		fanSpeed = std::max(fanSpeed, curveFanSpeed);
+	}
+
+	return std::min(std::max(fanSpeed, MIN_FAN_SPEED), MAX_FAN_SPEED);
+}
+
+int AbstractDevice::getFedForwardFanSpeed(int load, int fanSpeed, std::chrono::steady_clock::time_point now) {
+	double seconds = std::chrono::duration<double>(now - lastFeedForwardUpdate).count();
+	lastFeedForwardUpdate = now;
+
+	int fedForwardFanSpeed = fanSpeed + static_cast<int>(std::lround(feedForward->update(load, seconds)));
+	return std::min(fedForwardFanSpeed, MAX_FAN_SPEED);
+}
+
+int AbstractDevice::getFanSpeed(const Parameters &current, int currentTemperature, int hysteresis) {
+	for (const std::pair<const int, int>& kv : current.pairs) {
 		if (currentTemperature < kv.first - hysteresis) {
 			return kv.second;
 		}
 	}
 
-	return 100;
+	return MAX_FAN_SPEED;
+}
+
+int AbstractDevice::getInterpolatedFanSpeed(const Parameters &current, double currentTemperature) {
+	const std::map<int, int> &pairs = current.pairs;
+
+	// like the step curve, the fan runs with full speed from the highest temperature of the curve on
+	if (pairs.empty() || currentTemperature >= pairs.rbegin()->first) {
+		return MAX_FAN_SPEED;
+	}
+
+	if (currentTemperature <= pairs.begin()->first) {
+		return pairs.begin()->second;
+	}
+
+	std::map<int, int>::const_iterator upper = pairs.upper_bound(static_cast<int>(std::floor(currentTemperature)));
+	std::map<int, int>::const_iterator lower = std::prev(upper);
+
+	double x0 = lower->first;
+	double x1 = upper->first;
+	double y0 = lower->second;
+	double y1 = upper->second;
+	double width = x1 - x0;
+	double t = (currentTemperature - x0) / width;
+
+	if (current.interpolation == INTERPOLATION_LINEAR) {
+		return static_cast<int>(std::lround(y0 + t * (y1 - y0)));
+	}
+
+	// monotone cubic hermite spline with the tangents of Fritsch and Carlson,
+	// which does not overshoot between the points, so the curve stays monotonic
+	auto secant = [](std::map<int, int>::const_iterator from) {
+		std::map<int, int>::const_iterator to = std::next(from);
+		return static_cast<double>(to->second - from->second) / (to->first - from->first);
+	};
+
+	auto tangent = [&pairs, &secant](std::map<int, int>::const_iterator point) {
+		bool isFirst = point == pairs.begin();
+		bool isLast = std::next(point) == pairs.end();
+
+		if (isFirst) {
+			return secant(point);
+		}
+
+		if (isLast) {
+			return secant(std::prev(point));
+		}
+
+		double before = secant(std::prev(point));
+		double after = secant(point);
+		if (before * after <= 0) {
+			return 0.0;
+		}
+
+		return (before + after) / 2;
+	};
+
+	double slope = secant(lower);
+	double m0 = 0;
+	double m1 = 0;
+
+	if (slope != 0) {
+		m0 = tangent(lower);
+		m1 = tangent(upper);
+
+		double alpha = m0 / slope;
+		double beta = m1 / slope;
+		double length = alpha * alpha + beta * beta;
+		if (length > 9) {
+			double tau = 3 / std::sqrt(length);
+			m0 = tau * alpha * slope;
+			m1 = tau * beta * slope;
+		}
+	}
+
+	double t2 = t * t;
+	double t3 = t2 * t;
+	double y = (2 * t3 - 3 * t2 + 1) * y0 + (t3 - 2 * t2 + t) * width * m0
+			+ (-2 * t3 + 3 * t2) * y1 + (t3 - t2) * width * m1;
+
+	return static_cast<int>(std::lround(y));
 }
 
-int AbstractDevice::calculateOptimalFanSpeed(int currentTemperature) const {
-	int optimalFanSpeedWithoutHysteresis = getFanSpeed(currentTemperature, 0);
+void AbstractDevice::setTemperatureSource(const std::shared_ptr<SensorAggregation> &temperatureSource) {
+	changeParameters([&temperatureSource](Parameters &changed) {
+		changed.temperatureSource = temperatureSource;
+	});
+}
+
+void AbstractDevice::setInterpolation(Interpolation interpolation) {
+	changeParameters([interpolation](Parameters &changed) {
+		changed.interpolation = interpolation;
+	});
+}
+
+void AbstractDevice::compileFanSpeedTables(Parameters &changed) {
+	for (int temperature = MIN_TEMPERATURE_VALID; temperature <= MAX_TEMPERATURE_VALID; ++temperature) {
+		if (changed.interpolation == INTERPOLATION_STEP) {
+			changed.fanSpeedTable[temperature - MIN_TEMPERATURE_VALID] = getFanSpeed(changed, temperature, 0);
+			changed.fanSpeedTableWithHysteresis[temperature - MIN_TEMPERATURE_VALID] =
+					getFanSpeed(changed, temperature, changed.hysteresis);
+		} else {
+			changed.fanSpeedTable[temperature - MIN_TEMPERATURE_VALID] =
+					getInterpolatedFanSpeed(changed, temperature);
+			changed.fanSpeedTableWithHysteresis[temperature - MIN_TEMPERATURE_VALID] =
+					getInterpolatedFanSpeed(changed, temperature + changed.hysteresis);
+		}
+	}
+}
+
+int AbstractDevice::calculateOptimalFanSpeed(const Parameters &current, int currentTemperature) const {
+	if (currentTemperature < MIN_TEMPERATURE_VALID || currentTemperature > MAX_TEMPERATURE_VALID) {
+		if (current.interpolation != INTERPOLATION_STEP) {
+			return currentTemperature < MIN_TEMPERATURE_VALID ? current.fanSpeedTable.front() : MAX_FAN_SPEED;
+		}
+
+		int optimalFanSpeedWithoutHysteresis = getFanSpeed(current, currentTemperature, 0);
+
+		if (optimalFanSpeedWithoutHysteresis < currentFanSpeed) {
+			return getFanSpeed(current, currentTemperature, current.hysteresis);
+		}
+
+		return optimalFanSpeedWithoutHysteresis;
+	}
+
+	int optimalFanSpeedWithoutHysteresis = current.fanSpeedTable[currentTemperature - MIN_TEMPERATURE_VALID];
 
 	if (optimalFanSpeedWithoutHysteresis < currentFanSpeed) {
-		return getFanSpeed(currentTemperature, hysteresis);
+		int optimalFanSpeedWithHysteresis =
+				current.fanSpeedTableWithHysteresis[currentTemperature - MIN_TEMPERATURE_VALID];
+
+		// an interpolated curve rises on every degree, the shifted fan speed would be higher than the current one
+		// after a falling temperature, so the hysteresis only holds the current fan speed
+		if (current.interpolation != INTERPOLATION_STEP) {
+			return std::max(optimalFanSpeedWithoutHysteresis,
+					std::min(currentFanSpeed, optimalFanSpeedWithHysteresis));
+		}
+
+		return optimalFanSpeedWithHysteresis;
 	}
 
 	return optimalFanSpeedWithoutHysteresis;
 }
 
-bool AbstractDevice::checkIfValid() const {
-	if (hysteresis < 0 || hysteresis > MAX_HYSTERESIS_VALID) {
-		return false;
+void AbstractDevice::checkAttributes(InvalidAttributes &invalidAttributes) const {
+	checkParameters(getParameters(), invalidAttributes);
+}
+
+void AbstractDevice::checkParameters(const Parameters &current, InvalidAttributes &invalidAttributes) {
+	const FanSpeedTable &fanSpeedTable = current.fanSpeedTable;
+	const FanSpeedTable &fanSpeedTableWithHysteresis = current.fanSpeedTableWithHysteresis;
+	const std::string temperatureRange = (boost::format(gettext("must be between %d and %d"))
+			% MIN_TEMPERATURE_VALID % MAX_TEMPERATURE_VALID).str();
+
+	if (current.hysteresis < 0 || current.hysteresis > MAX_HYSTERESIS_VALID) {
+		invalidAttributes.push_back({"hysteresis",
+				(boost::format(gettext("must be between %d and %d")) % 0 % MAX_HYSTERESIS_VALID).str()});
 	}
 
-	if (warn < MIN_TEMPERATURE_VALID || warn > MAX_TEMPERATURE_VALID) {
-		return false;
+	if (current.warn < MIN_TEMPERATURE_VALID || current.warn > MAX_TEMPERATURE_VALID) {
+		invalidAttributes.push_back({"warn", temperatureRange});
 	}
 
+	if (current.minInterval <= std::chrono::milliseconds::zero()) {
+		invalidAttributes.push_back({"minInterval", gettext("must be positive")});
+	} else if (current.minInterval > current.maxInterval) {
+		invalidAttributes.push_back({"minInterval", gettext("must not be greater than maxInterval")});
+	}
+
+	if (current.temperatureSource) {
+		current.temperatureSource->checkAttributes(invalidAttributes);
+	}
+
+	if (current.controller) {
+		PidController(*current.controller).checkAttributes(invalidAttributes);
+	}
+
+	if (current.feedForward) {
+		FeedForward(*current.feedForward).checkAttributes(invalidAttributes);
+	}
+
+	if (current.minFanSpeedDelta < 0 || current.minFanSpeedDelta > MAX_FAN_SPEED) {
+		invalidAttributes.push_back({"writeMinDelta",
+				(boost::format(gettext("must be between %d and %d")) % 0 % MAX_FAN_SPEED).str()});
+	}
+
+	if (current.minFanSpeedDwell < std::chrono::milliseconds::zero()) {
+		invalidAttributes.push_back({"writeMinDwell", gettext("must not be negative")});
+	}
+
+	// not an attribute of the configuration file, only set by a command of the control socket
+	if (current.override == OVERRIDE_FAN_SPEED
+			&& (current.overrideFanSpeed < MIN_FAN_SPEED || current.overrideFanSpeed > MAX_FAN_SPEED)) {
+		invalidAttributes.push_back({"", gettext("the fan speed of the override is not valid")});
+	}
+
+	const std::size_t invalidAttributesBeforeCurve = invalidAttributes.size();
 	int oldFanSpeed = -1;
 
-	for (std::pair<const int, int> pair : pairs) {
+	for (std::pair<const int, int> pair : current.pairs) {
 		if (pair.first < MIN_TEMPERATURE_VALID || pair.first > MAX_TEMPERATURE_VALID) {
-			return false;
+			invalidAttributes.push_back({std::to_string(pair.first), (boost::format(gettext(
+					"is not a temperature between %d and %d")) % MIN_TEMPERATURE_VALID % MAX_TEMPERATURE_VALID).str()});
+		} else if (pair.second < MIN_FAN_SPEED || pair.second > MAX_FAN_SPEED) {
+			invalidAttributes.push_back({std::to_string(pair.first),
+					(boost::format(gettext("must be between %d and %d")) % MIN_FAN_SPEED % MAX_FAN_SPEED).str()});
+		} else if (pair.second < oldFanSpeed) {
+			invalidAttributes.push_back({std::to_string(pair.first),
+					gettext("must not be lower than the fan speed of a lower temperature")});
 		}
 
-		if (pair.second < oldFanSpeed) {
-			return false;
-		}
+		oldFanSpeed = std::max(oldFanSpeed, pair.second);
+	}
+
+	// the tables are compiled from the pairs, an invalid table without an invalid pair is reported for the device
+	if (invalidAttributes.size() > invalidAttributesBeforeCurve) {
+		return;
+	}
 
-		oldFanSpeed = pair.second;
+	for (std::size_t i = 0; i < fanSpeedTable.size(); ++i) {
+		// the hysteresis keeps the fan speed up while the temperature falls, it never lowers the fan speed
+		if (fanSpeedTable[i] < MIN_FAN_SPEED || fanSpeedTableWithHysteresis[i] < fanSpeedTable[i]
+				|| fanSpeedTableWithHysteresis[i] > MAX_FAN_SPEED
+				|| (i > 0 && (fanSpeedTable[i] < fanSpeedTable[i - 1]
+				|| fanSpeedTableWithHysteresis[i] < fanSpeedTableWithHysteresis[i - 1]))) {
+			invalidAttributes.push_back({"", gettext("the curve is not valid")});
+			return;
+		}
 	}
-	return true;
 }
 
 }
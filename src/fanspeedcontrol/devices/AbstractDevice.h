@@ -18,17 +18,37 @@
 #ifndef FANSPEEDCONTROL_DEVICES_ABSTRACTDEVICE_H_
 #define FANSPEEDCONTROL_DEVICES_ABSTRACTDEVICE_H_
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "fanspeedcontrol/control/FeedForward.h"
+#include "fanspeedcontrol/control/PidController.h"
+#include "fanspeedcontrol/devices/InvalidAttribute.h"
+#include "fanspeedcontrol/sensors/SensorAggregation.h"
+#include "patterns/clock/Clock.h"
 #include "patterns/observer/AbstractObserver.h"
+#include "patterns/observer/Event.h"
 #include "patterns/observer/Observable.h"
+#include "patterns/rcu/RcuPointer.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
 
+const int MIN_TEMPERATURE_VALID = 0;
+const int MAX_TEMPERATURE_VALID = 120;
+const int MIN_FAN_SPEED = 0;
+const int MAX_FAN_SPEED = 100;
+
+// fan speed for every valid temperature, index is the temperature
+typedef std::array<int, MAX_TEMPERATURE_VALID - MIN_TEMPERATURE_VALID + 1> FanSpeedTable;
+
 class AbstractDevice : public msc42::patterns::Observable {
 public:
 	enum AbstractDeviceMessages : const int  {
@@ -42,33 +62,193 @@ public:
 		DEVICE_CONFIG,
 		TEMPERATURE_WARN,
 		DEVICE_TERMINATED,
-		DEVICE_TERMINATED_ERROR
+		DEVICE_TERMINATED_ERROR,
+		LATENCY_REPORT,
+		CONFIG_RELOADED,
+		CONFIG_RELOAD_ERROR,
+		CONFIG_RELOAD_DEVICES_CHANGED,
+		CONTROL_COMMAND,
+		// number of messages, not a message
+		MESSAGES_COUNT
+	};
+
+	enum Interpolation {
+		INTERPOLATION_STEP,
+		INTERPOLATION_LINEAR,
+		INTERPOLATION_MONOTONE_CUBIC
+	};
+
+	// temporary replacement of the control, e.g. by a command of the control socket
+	enum Override {
+		OVERRIDE_NONE,
+		OVERRIDE_FAN_SPEED,
+		OVERRIDE_AUTOMATIC_MODE
+	};
+
+	// durations of the phases of the last call of setOptimalFanSpeed
+	struct PhaseDurations {
+		std::chrono::steady_clock::duration read;
+		std::chrono::steady_clock::duration compute;
+		std::chrono::steady_clock::duration write;
+	};
+
+	// parameters, which can be changed while the device is controlled, the control thread reads them without a lock
+	// once per call of setOptimalFanSpeed, every change publishes a copy with the next version
+	struct Parameters {
+		unsigned long version = 0;
+		int hysteresis;
+		int warn;
+		std::map<int, int> pairs;
+		Interpolation interpolation = INTERPOLATION_STEP;
+
+		// the curve compiled from pairs, so that the fan speed is a single lookup per temperature
+		FanSpeedTable fanSpeedTable;
+		FanSpeedTable fanSpeedTableWithHysteresis;
+
+		std::chrono::milliseconds minInterval = std::chrono::milliseconds(500);
+		std::chrono::milliseconds maxInterval = std::chrono::milliseconds(500);
+
+		int minFanSpeedDelta = 0;
+		std::chrono::milliseconds minFanSpeedDwell = std::chrono::milliseconds::zero();
+
+		// if set, the temperature is aggregated from shared sensors instead of read from the device
+		std::shared_ptr<SensorAggregation> temperatureSource;
+		// if set, the fan speed is controlled to the target temperature and the curve is only the fallback
+		std::optional<PidController::parameters> controller;
+		std::optional<FeedForward::parameters> feedForward;
+
+		// not taken from a reloaded configuration, the override ends at overrideEnd of the clock of the device
+		Override override = OVERRIDE_NONE;
+		int overrideFanSpeed = -1;
+		std::chrono::steady_clock::time_point overrideEnd;
 	};
 
 	AbstractDevice(const std::string &type, int id, int hysteresis, int warn, const std::map<int, int> &pairs);
 	virtual ~AbstractDevice();
 	virtual void setOptimalFanSpeed();
 	virtual std::string to_string(bool verbose = false) const;
-	virtual bool checkIfValid() const;
+	static std::string to_string(const msc42::patterns::Event &event);
+	// adds every attribute of the configuration file with a value, which is not valid,
+	// e.g. a curve which is not monotonic or a file of the device which cannot be opened
+	virtual void checkAttributes(InvalidAttributes &invalidAttributes) const;
+
+	virtual void setPollIntervals(const std::chrono::milliseconds &minInterval,
+			const std::chrono::milliseconds &maxInterval);
+	virtual std::chrono::milliseconds getPollInterval() const;
+
+	virtual void setInterpolation(Interpolation interpolation);
+	virtual void setTemperatureSource(const std::shared_ptr<SensorAggregation> &temperatureSource);
+	// position of the device in the configuration, observers use it as key for their tables
+	virtual void setIndex(int index);
+	// time source of the timestamps and the simulation, the steady clock if not set
+	virtual void setClock(const std::shared_ptr<msc42::patterns::Clock> &clock);
+	// if set, the fan speed is controlled by the pid controller and the curve is only the fallback
+	virtual void setController(const PidController::parameters &pidParameters);
+	// if set, the fan speed is increased ahead of the temperature when the load of the device rises
+	virtual void setFeedForward(const FeedForward::parameters &feedForwardParameters);
+	// fan speed changes smaller than minFanSpeedDelta and decreases within minFanSpeedDwell after the last write
+	// are not written, except to the limits of the fan speed and from the warn temperature on
+	virtual void setWriteCoalescing(int minFanSpeedDelta, const std::chrono::milliseconds &minFanSpeedDwell);
+
+	// the setters and these functions can be called from any thread while the device is controlled,
+	// the changed parameters are taken at the begin of the next call of setOptimalFanSpeed,
+	// the state of the device (fan speed, mode, state of the controller with unchanged parameters) is kept,
+	// the parameters are not checked, e.g. because they are checked before with checkChangedParameters
+	void setParameters(const std::function<void(Parameters &)> &change);
+	// adds every parameter, which is not valid after change, without changing the parameters or using the hardware
+	void checkChangedParameters(const std::function<void(Parameters &)> &change,
+			InvalidAttributes &invalidAttributes) const;
+	// the curve is compiled after update, returns false and keeps the parameters if they are not valid
+	bool updateParameters(const std::function<void(Parameters &)> &update);
+	Parameters getParameters() const;
+	// the fan speed is set to fanSpeed or the device is set to automatic mode for duration,
+	// OVERRIDE_NONE ends an override, from the warn temperature on the override is ignored,
+	// returns false if the fan speed is not valid
+	bool setOverride(Override override, int fanSpeed, const std::chrono::milliseconds &duration);
+	// sets the automatic mode or, if this is not possible, the maximal fan speed, e.g. by the watchdog,
+	// returns false if both are not possible
+	virtual bool setFailSafeMode();
+
+	const std::string &getType() const;
+	int getId() const;
+	int getLastTemperature() const;
+	int getCurrentFanSpeed() const;
+	bool isAutomaticMode() const;
+	Override getActiveOverride() const;
+	// suppressed fan speed writes and mode writes which were not necessary, can be called from any thread
+	unsigned long getAvoidedWrites() const;
+	const PhaseDurations &getLastPhaseDurations() const;
 
 protected:
 	const std::string typeString;
 	const int id;
-	const int hysteresis;
-	const int warn;
-	const std::map<int, int> pairs;
+
+	// read only by the control thread, which announces with quiescent after every call of setOptimalFanSpeed,
+	// that it holds no reference anymore, so that replaced parameters can be deleted
+	msc42::patterns::RcuPointer<Parameters> parameters;
+	// version of the parameters, to which the controller, the feed-forward and the poll interval are adapted
+	unsigned long appliedVersion = 0;
+
+	// created from the parameters, they are kept with their state as long as their parameters are unchanged
+	std::unique_ptr<PidController> controller;
+	std::chrono::steady_clock::time_point lastControllerUpdate;
+
+	std::unique_ptr<FeedForward> feedForward;
+	std::chrono::steady_clock::time_point lastFeedForwardUpdate;
+
+	// the state of the aggregation is kept as long as the temperature source of the parameters is the same
+	std::shared_ptr<SensorAggregation> averagedTemperatureSource;
+	SensorAggregation::Average temperatureAverage;
 
 	int currentFanSpeed = -1;
 	bool automaticMode = false;
+	// true only if the manual mode is known to be set, then it is not set again for every fan speed
+	bool manualMode = false;
 	bool manualModeWasSetAtLeastOnce = false;
+	Override activeOverride = OVERRIDE_NONE;
+
+	std::chrono::steady_clock::time_point lastFanSpeedWrite;
+	// written only by the control thread, read by other threads, e.g. for the metrics
+	std::atomic<unsigned long> avoidedWrites{0};
+
+	std::shared_ptr<msc42::patterns::Clock> clock;
+
+	// type and id of the device are filled in once, the events are copied from it
+	msc42::patterns::Event eventTemplate;
+
+	std::chrono::milliseconds pollInterval = std::chrono::milliseconds(500);
+	int lastTemperature = -1;
+	PhaseDurations lastPhaseDurations = PhaseDurations();
 
 	virtual int getTemperature() = 0;
 	virtual bool setFanSpeed(int speed) = 0;
 	virtual bool setManualMode() = 0;
 	virtual bool setAutomaticMode() = 0;
+	// load in percent, e.g. the utilization, negative if the device does not provide it
+	virtual int getLoad();
+
+	msc42::patterns::Event createEvent(int messageId, int temperature = -274) const;
+	void countAvoidedWrite();
 
-	virtual int calculateOptimalFanSpeed(int currentTemperature) const;
-	virtual int getFanSpeed(int currentTemperature, int hysteresis) const;
+	virtual void controlFanSpeed(const Parameters &current);
+	void switchToAutomaticMode(int temperature);
+	virtual int calculateOptimalFanSpeed(const Parameters &current, int currentTemperature) const;
+	virtual int getControlledFanSpeed(const Parameters &current, int currentTemperature, int curveFanSpeed);
+	virtual int getFedForwardFanSpeed(int load, int fanSpeed, std::chrono::steady_clock::time_point now);
+	static int getFanSpeed(const Parameters &current, int currentTemperature, int hysteresis);
+	virtual bool isFanSpeedWriteNeeded(const Parameters &current, int optimalFanSpeed, int currentTemperature,
+			std::chrono::steady_clock::time_point now) const;
+	static int getInterpolatedFanSpeed(const Parameters &current, double currentTemperature);
+	static std::unique_ptr<const Parameters> createParameters(int hysteresis, int warn,
+			const std::map<int, int> &pairs);
+	static void compileFanSpeedTables(Parameters &changed);
+	static void checkParameters(const Parameters &current, InvalidAttributes &invalidAttributes);
+	// adapts the controller, the feed-forward and the poll interval to a new version of the parameters
+	virtual void applyParameters(const Parameters &current);
+	virtual void adaptPollInterval(const Parameters &current, int currentTemperature);
+	virtual bool isNearBreakpoint(const Parameters &current, int currentTemperature) const;
+	// for the setters, which are called while the configuration is built, the parameters are checked afterwards
+	void changeParameters(const std::function<void(Parameters &)> &change);
 };
 
 }
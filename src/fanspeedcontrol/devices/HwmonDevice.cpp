@@ -0,0 +1,101 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "HwmonDevice.h"
+
+#include <map>
+#include <string>
+
+#include <libintl.h>
+
+#include "AbstractDevice.h"
+#include "SysfsFile.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+const int MAX_PWM = 255;
+
+const int PWM_ENABLE_MANUAL = 1;
+const int PWM_ENABLE_AUTOMATIC = 2;
+
+const int MILLIDEGREES_PER_DEGREE = 1000;
+
+HwmonDevice::HwmonDevice(int id, int hysteresis, int warn, const std::map<int, int> &pairs,
+		const std::string &sysfsRoot, const std::string &temperatureInput, const std::string &pwm)
+: AbstractDevice("hwmon", id, hysteresis, warn, pairs),
+  temperatureFile(temperatureInput.empty() ? "" : sysfsRoot + "/" + temperatureInput, false),
+  pwmFile(sysfsRoot + "/" + pwm, true), pwmEnableFile(sysfsRoot + "/" + pwm + "_enable", true) {
+	// restore the mode of the driver at the end, unless the fan was already left in manual mode
+	if (!pwmEnableFile.readInt(originalPwmEnable) || originalPwmEnable == PWM_ENABLE_MANUAL) {
+		originalPwmEnable = PWM_ENABLE_AUTOMATIC;
+	}
+}
+
+HwmonDevice::~HwmonDevice() {
+	if (manualModeWasSetAtLeastOnce) {
+		if (setAutomaticMode()) {
+			notifyObservers(createEvent(DEVICE_TERMINATED));
+		} else {
+			notifyObservers(createEvent(DEVICE_TERMINATED_ERROR));
+		}
+	}
+}
+
+void HwmonDevice::checkAttributes(InvalidAttributes &invalidAttributes) const {
+	// the temperature file is not necessary if the temperature is read from sensors
+	if (!temperatureFile.isOpen() && !getParameters().temperatureSource) {
+		invalidAttributes.push_back({"temperatureInput", gettext("cannot be opened")});
+	}
+
+	if (!pwmFile.isOpen()) {
+		invalidAttributes.push_back({"pwm", gettext("cannot be opened")});
+	} else if (!pwmEnableFile.isOpen()) {
+		invalidAttributes.push_back({"pwm", gettext("has no file with the suffix _enable, which can be opened")});
+	}
+
+	AbstractDevice::checkAttributes(invalidAttributes);
+}
+
+int HwmonDevice::getTemperature() {
+	return readTemperature(temperatureFile);
+}
+
+int HwmonDevice::readTemperature(const SysfsFile &temperatureFile) {
+	int millidegrees;
+
+	if (!temperatureFile.readInt(millidegrees)) {
+		return -274;
+	}
+
+	return (millidegrees + MILLIDEGREES_PER_DEGREE / 2) / MILLIDEGREES_PER_DEGREE;
+}
+
+bool HwmonDevice::setFanSpeed(int speed) {
+	return pwmFile.writeInt((speed * MAX_PWM + MAX_FAN_SPEED / 2) / MAX_FAN_SPEED);
+}
+
+bool HwmonDevice::setManualMode() {
+	return pwmEnableFile.writeInt(PWM_ENABLE_MANUAL);
+}
+
+bool HwmonDevice::setAutomaticMode() {
+	return pwmEnableFile.writeInt(originalPwmEnable);
+}
+
+}
+}
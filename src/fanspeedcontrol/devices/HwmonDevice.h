@@ -0,0 +1,56 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_DEVICES_HWMONDEVICE_H_
+#define FANSPEEDCONTROL_DEVICES_HWMONDEVICE_H_
+
+#include <map>
+#include <string>
+
+#include "AbstractDevice.h"
+#include "SysfsFile.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// fan controlled by the pwm files of the linux hwmon sysfs interface
+class HwmonDevice: public AbstractDevice {
+public:
+	HwmonDevice(int id, int hysteresis, int warn, const std::map<int, int> &pairs, const std::string &sysfsRoot,
+			const std::string &temperatureInput, const std::string &pwm);
+	virtual ~HwmonDevice();
+
+	virtual void checkAttributes(InvalidAttributes &invalidAttributes) const;
+
+	static int readTemperature(const SysfsFile &temperatureFile);
+
+protected:
+	const SysfsFile temperatureFile;
+	const SysfsFile pwmFile;
+	const SysfsFile pwmEnableFile;
+	int originalPwmEnable = -1;
+
+	virtual int getTemperature();
+	virtual bool setFanSpeed(int speed);
+	virtual bool setManualMode();
+	virtual bool setAutomaticMode();
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_DEVICES_HWMONDEVICE_H_ */
@@ -0,0 +1,40 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef FANSPEEDCONTROL_DEVICES_INVALIDATTRIBUTE_H_
+#define FANSPEEDCONTROL_DEVICES_INVALIDATTRIBUTE_H_
+
+#include <string>
+#include <vector>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// attribute of the configuration file with a value, which is not valid, e.g. {"warn", "must be between 0 and 120"},
+// an empty attribute stands for the whole device
+struct InvalidAttribute {
+	std::string attribute;
+	std::string message;
+};
+
+typedef std::vector<InvalidAttribute> InvalidAttributes;
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_DEVICES_INVALIDATTRIBUTE_H_ */
@@ -17,7 +17,10 @@
 
 #include "NvidiaGpu.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -26,32 +29,37 @@
 #include <X11/Xlib.h>
 
 #include "AbstractDevice.h"
+#include "XDisplayConnection.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
 
 NvidiaGpu::NvidiaGpu(int id, int hysteresis, int warn, const std::map<int, int> &pairs, const std::string &displayName)
-: AbstractDevice("nvidia", id, hysteresis, warn, pairs), displayName(displayName) {
-	dpy = XOpenDisplay(displayName.c_str());
+: AbstractDevice("nvidia", id, hysteresis, warn, pairs), displayName(displayName),
+  connection(XDisplayConnection::getConnection(displayName)) {
 }
 
 NvidiaGpu::~NvidiaGpu() {
 	if (manualModeWasSetAtLeastOnce) {
 		if (setAutomaticMode()) {
-			notifyObservers(DEVICE_TERMINATED, to_string());
+			notifyObservers(createEvent(DEVICE_TERMINATED));
 		} else {
-			notifyObservers(DEVICE_TERMINATED_ERROR, to_string());
+			notifyObservers(createEvent(DEVICE_TERMINATED_ERROR));
 		}
 	}
-
-	XCloseDisplay(dpy);
 }
 
 int NvidiaGpu::getTemperature() {
+	return readTemperature(*connection, id);
+}
+
+int NvidiaGpu::readTemperature(XDisplayConnection &connection, int id) {
 	int temperature;
 
-	bool isTemperatureRead = XNVCTRLQueryTargetAttribute(dpy, NV_CTRL_TARGET_TYPE_GPU,
-			id, display_mask, NV_CTRL_GPU_CORE_TEMPERATURE, &temperature);
+	bool isTemperatureRead = connection.request(id, [id, &temperature](Display *dpy) {
+		return XNVCTRLQueryTargetAttribute(dpy, NV_CTRL_TARGET_TYPE_GPU,
+				id, display_mask, NV_CTRL_GPU_CORE_TEMPERATURE, &temperature);
+	});
 
 	if (!isTemperatureRead) {
 		return -274;
@@ -60,19 +68,50 @@ int NvidiaGpu::getTemperature() {
 	return temperature;
 }
 
+int NvidiaGpu::getLoad() {
+	int load = -1;
+
+	// the utilization is a string like "graphics=45, memory=12, video=0, PCIe=0",
+	// it is optional, so that a driver without it does not close the display for the control
+	connection->requestOptional([this, &load](Display *dpy) {
+		char *utilization = nullptr;
+		if (!XNVCTRLQueryTargetStringAttribute(dpy, NV_CTRL_TARGET_TYPE_GPU,
+				id, display_mask, NV_CTRL_STRING_GPU_UTILIZATION, &utilization) || utilization == nullptr) {
+			return false;
+		}
+
+		const char *graphics = std::strstr(utilization, "graphics=");
+		if (graphics != nullptr) {
+			load = std::atoi(graphics + std::strlen("graphics="));
+		}
+		XFree(utilization);
+
+		return graphics != nullptr;
+	});
+
+	return load;
+}
+
 bool NvidiaGpu::setFanSpeed(int speed) {
-	return XNVCTRLSetTargetAttributeAndGetStatus(dpy, NV_CTRL_TARGET_TYPE_COOLER,
-			id, display_mask, NV_CTRL_THERMAL_COOLER_LEVEL, speed);
+	return connection->request(id, [this, speed](Display *dpy) {
+		return XNVCTRLSetTargetAttributeAndGetStatus(dpy, NV_CTRL_TARGET_TYPE_COOLER,
+				id, display_mask, NV_CTRL_THERMAL_COOLER_LEVEL, speed);
+	});
 }
 
 bool NvidiaGpu::setManualMode() {
-	return XNVCTRLSetTargetAttributeAndGetStatus(dpy, NV_CTRL_TARGET_TYPE_GPU,
-			id, display_mask, NV_CTRL_GPU_COOLER_MANUAL_CONTROL, NV_CTRL_GPU_COOLER_MANUAL_CONTROL_TRUE);
+	return connection->request(id, [this](Display *dpy) {
+		return XNVCTRLSetTargetAttributeAndGetStatus(dpy, NV_CTRL_TARGET_TYPE_GPU,
+				id, display_mask, NV_CTRL_GPU_COOLER_MANUAL_CONTROL, NV_CTRL_GPU_COOLER_MANUAL_CONTROL_TRUE);
+	});
 }
 
 bool NvidiaGpu::setAutomaticMode() {
-	return XNVCTRLSetTargetAttributeAndGetStatus(dpy, NV_CTRL_TARGET_TYPE_GPU,
-			id, display_mask, NV_CTRL_GPU_COOLER_MANUAL_CONTROL, NV_CTRL_GPU_COOLER_MANUAL_CONTROL_FALSE);
+	// the automatic mode protects the device, so try to reconnect immediately without waiting for the backoff
+	return connection->request(id, [this](Display *dpy) {
+		return XNVCTRLSetTargetAttributeAndGetStatus(dpy, NV_CTRL_TARGET_TYPE_GPU,
+				id, display_mask, NV_CTRL_GPU_COOLER_MANUAL_CONTROL, NV_CTRL_GPU_COOLER_MANUAL_CONTROL_FALSE);
+	}, true);
 }
 
 }
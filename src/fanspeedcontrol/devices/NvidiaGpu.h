@@ -18,11 +18,11 @@
 #ifndef FANSPEEDCONTROL_DEVICES_NVIDIAGPU_H_
 #define FANSPEEDCONTROL_DEVICES_NVIDIAGPU_H_
 
+#include <memory>
 #include <string>
 
-#include <X11/Xlib.h>
-
 #include "AbstractDevice.h"
+#include "XDisplayConnection.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
@@ -32,15 +32,18 @@ public:
 	NvidiaGpu(int id, int hysteresis, int warn, const std::map<int, int> &pairs, const std::string &displayName);
 	virtual ~NvidiaGpu();
 
+	static int readTemperature(XDisplayConnection &connection, int id);
+
 protected:
 	const std::string displayName;
-	Display *dpy;
-	const unsigned int display_mask = 0u;
+	std::shared_ptr<XDisplayConnection> connection;
+	static const unsigned int display_mask = 0u;
 
 	virtual int getTemperature();
 	virtual bool setFanSpeed(int speed);
 	virtual bool setManualMode();
 	virtual bool setAutomaticMode();
+	virtual int getLoad();
 };
 
 }
@@ -0,0 +1,92 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "NvmlGpu.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <libintl.h>
+
+#include "AbstractDevice.h"
+#include "NvmlLibrary.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+NvmlGpu::NvmlGpu(int id, int hysteresis, int warn, const std::map<int, int> &pairs, const std::string &libraryPath)
+: AbstractDevice("nvml", id, hysteresis, warn, pairs), library(NvmlLibrary::getLibrary(libraryPath)) {
+	deviceFound = id >= 0 && library->getDevice(static_cast<unsigned int>(id), device);
+	if (deviceFound) {
+		fanCount = library->getFanCount(device);
+	}
+}
+
+NvmlGpu::~NvmlGpu() {
+	if (manualModeWasSetAtLeastOnce) {
+		if (setAutomaticMode()) {
+			notifyObservers(createEvent(DEVICE_TERMINATED));
+		} else {
+			notifyObservers(createEvent(DEVICE_TERMINATED_ERROR));
+		}
+	}
+}
+
+void NvmlGpu::checkAttributes(InvalidAttributes &invalidAttributes) const {
+	if (!library->isLoaded()) {
+		invalidAttributes.push_back({"nvmlLibrary", gettext("cannot be loaded")});
+	} else if (!deviceFound) {
+		invalidAttributes.push_back({"id", gettext("is not a device of the Nvidia management library")});
+	} else if (fanCount == 0) {
+		invalidAttributes.push_back({"id", gettext("is a device without a controllable fan")});
+	}
+
+	AbstractDevice::checkAttributes(invalidAttributes);
+}
+
+int NvmlGpu::getTemperature() {
+	return library->getTemperature(device);
+}
+
+bool NvmlGpu::setFanSpeed(int speed) {
+	bool success = true;
+	for (unsigned int fan = 0; fan < fanCount; ++fan) {
+		success = library->setFanSpeed(device, fan, static_cast<unsigned int>(speed)) && success;
+	}
+	return success;
+}
+
+bool NvmlGpu::setManualMode() {
+	// nvml switches a fan to manual mode when its speed is set
+	return true;
+}
+
+bool NvmlGpu::setAutomaticMode() {
+	bool success = true;
+	for (unsigned int fan = 0; fan < fanCount; ++fan) {
+		success = library->setDefaultFanSpeed(device, fan) && success;
+	}
+	return success;
+}
+
+int NvmlGpu::getLoad() {
+	return library->getLoad(device);
+}
+
+}
+}
@@ -0,0 +1,55 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_DEVICES_NVMLGPU_H_
+#define FANSPEEDCONTROL_DEVICES_NVMLGPU_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "AbstractDevice.h"
+#include "NvmlLibrary.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// nvidia gpu controlled by the nvidia management library instead of the x server, the id is the nvml index,
+// all fans of the gpu are set to the same speed
+class NvmlGpu: public AbstractDevice {
+public:
+	NvmlGpu(int id, int hysteresis, int warn, const std::map<int, int> &pairs, const std::string &libraryPath);
+	virtual ~NvmlGpu();
+	virtual void checkAttributes(InvalidAttributes &invalidAttributes) const;
+
+protected:
+	std::shared_ptr<NvmlLibrary> library;
+	NvmlLibrary::Device device = nullptr;
+	bool deviceFound = false;
+	unsigned int fanCount = 0;
+
+	virtual int getTemperature();
+	virtual bool setFanSpeed(int speed);
+	virtual bool setManualMode();
+	virtual bool setAutomaticMode();
+	virtual int getLoad();
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_DEVICES_NVMLGPU_H_ */
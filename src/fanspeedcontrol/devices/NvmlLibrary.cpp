@@ -0,0 +1,146 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "NvmlLibrary.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <dlfcn.h>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+const int NVML_SUCCESS = 0;
+const int NVML_TEMPERATURE_GPU = 0;
+
+std::mutex NvmlLibrary::librariesMutex;
+std::map<std::string, std::weak_ptr<NvmlLibrary>> NvmlLibrary::libraries;
+
+std::shared_ptr<NvmlLibrary> NvmlLibrary::getLibrary(const std::string &path) {
+	std::lock_guard<std::mutex> lock(librariesMutex);
+
+	std::shared_ptr<NvmlLibrary> library = libraries[path].lock();
+	if (!library) {
+		library = std::make_shared<NvmlLibrary>(path);
+		libraries[path] = library;
+	}
+
+	return library;
+}
+
+template <typename Function> bool NvmlLibrary::loadFunction(const char *name, Function &function) {
+	function = reinterpret_cast<Function>(dlsym(handle, name));
+	return function != nullptr;
+}
+
+NvmlLibrary::NvmlLibrary(const std::string &path) {
+	handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (!handle) {
+		return;
+	}
+
+	if (!loadFunction("nvmlInit_v2", init) || !loadFunction("nvmlShutdown", shutdown)
+			|| !loadFunction("nvmlDeviceGetHandleByIndex_v2", deviceGetHandleByIndex)
+			|| !loadFunction("nvmlDeviceGetTemperature", deviceGetTemperature)
+			|| !loadFunction("nvmlDeviceGetNumFans", deviceGetNumFans)
+			|| !loadFunction("nvmlDeviceSetFanSpeed_v2", deviceSetFanSpeed)
+			|| !loadFunction("nvmlDeviceSetDefaultFanSpeed_v2", deviceSetDefaultFanSpeed)) {
+		return;
+	}
+
+	loadFunction("nvmlDeviceGetUtilizationRates", deviceGetUtilizationRates);
+	loadFunction("nvmlDeviceGetPowerUsage", deviceGetPowerUsage);
+	loadFunction("nvmlDeviceGetEnforcedPowerLimit", deviceGetEnforcedPowerLimit);
+
+	initialized = init() == NVML_SUCCESS;
+}
+
+NvmlLibrary::~NvmlLibrary() {
+	if (initialized) {
+		shutdown();
+	}
+
+	if (handle) {
+		dlclose(handle);
+	}
+}
+
+bool NvmlLibrary::isLoaded() const {
+	return initialized;
+}
+
+bool NvmlLibrary::getDevice(unsigned int index, Device &device) const {
+	return initialized && deviceGetHandleByIndex(index, &device) == NVML_SUCCESS;
+}
+
+int NvmlLibrary::getTemperature(Device device) const {
+	unsigned int temperature;
+
+	if (!initialized || deviceGetTemperature(device, NVML_TEMPERATURE_GPU, &temperature) != NVML_SUCCESS) {
+		return -274;
+	}
+
+	return static_cast<int>(temperature);
+}
+
+unsigned int NvmlLibrary::getFanCount(Device device) const {
+	unsigned int fans;
+
+	if (!initialized || deviceGetNumFans(device, &fans) != NVML_SUCCESS) {
+		return 0;
+	}
+
+	return fans;
+}
+
+bool NvmlLibrary::setFanSpeed(Device device, unsigned int fan, unsigned int speed) const {
+	return initialized && deviceSetFanSpeed(device, fan, speed) == NVML_SUCCESS;
+}
+
+bool NvmlLibrary::setDefaultFanSpeed(Device device, unsigned int fan) const {
+	return initialized && deviceSetDefaultFanSpeed(device, fan) == NVML_SUCCESS;
+}
+
+int NvmlLibrary::getLoad(Device device) const {
+	int load = -1;
+
+	if (!initialized) {
+		return load;
+	}
+
+	Utilization utilization;
+	if (deviceGetUtilizationRates && deviceGetUtilizationRates(device, &utilization) == NVML_SUCCESS) {
+		load = static_cast<int>(utilization.gpu);
+	}
+
+	// power and power limit in milliwatts
+	unsigned int power;
+	unsigned int powerLimit;
+	if (deviceGetPowerUsage && deviceGetEnforcedPowerLimit && deviceGetPowerUsage(device, &power) == NVML_SUCCESS
+			&& deviceGetEnforcedPowerLimit(device, &powerLimit) == NVML_SUCCESS && powerLimit > 0) {
+		load = std::max(load, static_cast<int>(std::min(100ull, 100ull * power / powerLimit)));
+	}
+
+	return load;
+}
+
+}
+}
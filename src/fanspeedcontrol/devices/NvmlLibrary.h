@@ -0,0 +1,84 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_DEVICES_NVMLLIBRARY_H_
+#define FANSPEEDCONTROL_DEVICES_NVMLLIBRARY_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// nvidia management library, which needs no x server, it is loaded at runtime,
+// so that the application starts without it, and shared by all devices using the same file
+class NvmlLibrary {
+public:
+	typedef struct nvmlDevice_st *Device;
+
+	static std::shared_ptr<NvmlLibrary> getLibrary(const std::string &path);
+
+	NvmlLibrary(const std::string &path);
+	virtual ~NvmlLibrary();
+
+	// false if the library or one of the required functions is not found or the initialization failed
+	bool isLoaded() const;
+
+	bool getDevice(unsigned int index, Device &device) const;
+	// returns -274 on errors
+	int getTemperature(Device device) const;
+	// returns 0 on errors
+	unsigned int getFanCount(Device device) const;
+	bool setFanSpeed(Device device, unsigned int fan, unsigned int speed) const;
+	bool setDefaultFanSpeed(Device device, unsigned int fan) const;
+	// maximum of utilization and power draw relative to the power limit in percent, -1 if both are not available
+	int getLoad(Device device) const;
+
+private:
+	typedef int Return;
+	struct Utilization {
+		unsigned int gpu;
+		unsigned int memory;
+	};
+
+	static std::mutex librariesMutex;
+	static std::map<std::string, std::weak_ptr<NvmlLibrary>> libraries;
+
+	void *handle = nullptr;
+	bool initialized = false;
+
+	Return (*init)() = nullptr;
+	Return (*shutdown)() = nullptr;
+	Return (*deviceGetHandleByIndex)(unsigned int, Device *) = nullptr;
+	Return (*deviceGetTemperature)(Device, int, unsigned int *) = nullptr;
+	Return (*deviceGetNumFans)(Device, unsigned int *) = nullptr;
+	Return (*deviceSetFanSpeed)(Device, unsigned int, unsigned int) = nullptr;
+	Return (*deviceSetDefaultFanSpeed)(Device, unsigned int) = nullptr;
+	// optional, only for the load
+	Return (*deviceGetUtilizationRates)(Device, Utilization *) = nullptr;
+	Return (*deviceGetPowerUsage)(Device, unsigned int *) = nullptr;
+	Return (*deviceGetEnforcedPowerLimit)(Device, unsigned int *) = nullptr;
+
+	template <typename Function> bool loadFunction(const char *name, Function &function);
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_DEVICES_NVMLLIBRARY_H_ */
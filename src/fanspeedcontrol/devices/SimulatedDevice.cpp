@@ -0,0 +1,159 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SimulatedDevice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <random>
+
+#include <boost/format.hpp>
+#include <libintl.h>
+
+#include "AbstractDevice.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// cooling per second without fan, so that the temperature is limited in every mode
+const double PASSIVE_COOLING = 0.01;
+
+// fan speed in automatic mode, in which the device controls the fan itself
+const int AUTOMATIC_FAN_SPEED = 50;
+
+SimulatedDevice::SimulatedDevice(int id, int hysteresis, int warn, const std::map<int, int> &pairs,
+		double ambient, double heatInput, double cooling, double noise, unsigned int seed, int load,
+		std::chrono::milliseconds loadPeriod)
+: AbstractDevice("simulated", id, hysteresis, warn, pairs),
+  ambient(ambient), heatInput(heatInput), cooling(cooling), noise(noise), load(load), loadPeriod(loadPeriod),
+  temperature(ambient), fanSpeed(AUTOMATIC_FAN_SPEED), generator(seed), noiseDistribution(0, noise > 0 ? noise : 1) {
+}
+
+SimulatedDevice::~SimulatedDevice() {
+	if (manualModeWasSetAtLeastOnce) {
+		setAutomaticMode();
+		notifyObservers(createEvent(DEVICE_TERMINATED));
+	}
+}
+
+void SimulatedDevice::checkAttributes(InvalidAttributes &invalidAttributes) const {
+	if (ambient < MIN_TEMPERATURE_VALID || ambient > MAX_TEMPERATURE_VALID) {
+		invalidAttributes.push_back({"ambient", (boost::format(gettext("must be between %d and %d"))
+				% MIN_TEMPERATURE_VALID % MAX_TEMPERATURE_VALID).str()});
+	}
+
+	if (heatInput < 0) {
+		invalidAttributes.push_back({"heatInput", gettext("must not be negative")});
+	}
+
+	if (cooling < 0) {
+		invalidAttributes.push_back({"cooling", gettext("must not be negative")});
+	}
+
+	if (noise < 0) {
+		invalidAttributes.push_back({"noise", gettext("must not be negative")});
+	}
+
+	if (load < 0 || load > 100) {
+		invalidAttributes.push_back({"load", (boost::format(gettext("must be between %d and %d")) % 0 % 100).str()});
+	}
+
+	if (loadPeriod < std::chrono::milliseconds::zero()) {
+		invalidAttributes.push_back({"loadPeriod", gettext("must not be negative")});
+	}
+
+	AbstractDevice::checkAttributes(invalidAttributes);
+}
+
+int SimulatedDevice::getTemperature() {
+	update();
+
+	double reading = temperature;
+	if (noise > 0) {
+		reading += noiseDistribution(generator);
+	}
+
+	return static_cast<int>(std::lround(reading));
+}
+
+bool SimulatedDevice::setFanSpeed(int speed) {
+	update();
+	fanSpeed = speed;
+	return true;
+}
+
+bool SimulatedDevice::setManualMode() {
+	return true;
+}
+
+bool SimulatedDevice::setAutomaticMode() {
+	update();
+	fanSpeed = AUTOMATIC_FAN_SPEED;
+	return true;
+}
+
+int SimulatedDevice::getLoad() {
+	update();
+
+	std::chrono::steady_clock::time_point periodEnd;
+	return getLoad(lastUpdate, periodEnd);
+}
+
+int SimulatedDevice::getLoad(std::chrono::steady_clock::time_point time,
+		std::chrono::steady_clock::time_point &periodEnd) const {
+	if (loadPeriod == std::chrono::milliseconds::zero()) {
+		periodEnd = std::chrono::steady_clock::time_point::max();
+		return load;
+	}
+
+	std::chrono::steady_clock::duration period = loadPeriod;
+	std::chrono::steady_clock::duration::rep periods = (time - start) / period;
+	periodEnd = start + (periods + 1) * period;
+
+	return periods % 2 == 0 ? 0 : load;
+}
+
+void SimulatedDevice::update() {
+	std::chrono::steady_clock::time_point now = clock->now();
+
+	if (!started) {
+		started = true;
+		start = now;
+		lastUpdate = now;
+		return;
+	}
+
+	// exact solution for a constant fan speed and load, so that the model is stable for every time step,
+	// the time step is split at the changes of the load
+	double coolingRate = PASSIVE_COOLING + cooling * fanSpeed / MAX_FAN_SPEED;
+	while (lastUpdate < now) {
+		std::chrono::steady_clock::time_point periodEnd;
+		int currentLoad = getLoad(lastUpdate, periodEnd);
+		std::chrono::steady_clock::time_point end = std::min(periodEnd, now);
+
+		double seconds = std::chrono::duration<double>(end - lastUpdate).count();
+		double equilibrium = ambient + heatInput * currentLoad / 100 / coolingRate;
+		temperature = equilibrium + (temperature - equilibrium) * std::exp(-coolingRate * seconds);
+
+		lastUpdate = end;
+	}
+}
+
+}
+}
@@ -0,0 +1,76 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_DEVICES_SIMULATEDDEVICE_H_
+#define FANSPEEDCONTROL_DEVICES_SIMULATEDDEVICE_H_
+
+#include <chrono>
+#include <map>
+#include <random>
+
+#include "AbstractDevice.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// device without hardware, the temperature follows a thermal model with a single heat capacity:
+// it rises by heatInput degrees per second at full load and falls proportional to the difference to the ambient temperature,
+// with a small passive cooling plus cooling per second at full fan speed,
+// the readings get gaussian noise with the standard deviation noise,
+// the load in percent is constant or alternates between idle and load every loadPeriod seconds starting with idle
+class SimulatedDevice: public AbstractDevice {
+public:
+	SimulatedDevice(int id, int hysteresis, int warn, const std::map<int, int> &pairs, double ambient,
+			double heatInput, double cooling, double noise, unsigned int seed, int load = 100,
+			std::chrono::milliseconds loadPeriod = std::chrono::milliseconds::zero());
+	virtual ~SimulatedDevice();
+	virtual void checkAttributes(InvalidAttributes &invalidAttributes) const;
+
+protected:
+	const double ambient;
+	const double heatInput;
+	const double cooling;
+	const double noise;
+	const int load;
+	const std::chrono::milliseconds loadPeriod;
+
+	double temperature;
+	int fanSpeed;
+	bool started = false;
+	std::chrono::steady_clock::time_point start;
+	std::chrono::steady_clock::time_point lastUpdate;
+
+	std::mt19937 generator;
+	std::normal_distribution<double> noiseDistribution;
+
+	virtual int getTemperature();
+	virtual bool setFanSpeed(int speed);
+	virtual bool setManualMode();
+	virtual bool setAutomaticMode();
+	virtual int getLoad();
+
+	// load at the given time and the end of the period of this load
+	int getLoad(std::chrono::steady_clock::time_point time, std::chrono::steady_clock::time_point &periodEnd) const;
+
+	// integrates the model up to the current time of the clock
+	void update();
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_DEVICES_SIMULATEDDEVICE_H_ */
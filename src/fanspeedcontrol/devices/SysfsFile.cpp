@@ -0,0 +1,120 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SysfsFile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+SysfsFile::SysfsFile(const std::string &path, bool writable)
+: path(path), writable(writable), fd(-1) {
+	open();
+}
+
+SysfsFile::~SysfsFile() {
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+bool SysfsFile::isOpen() const {
+	return fd >= 0;
+}
+
+bool SysfsFile::readInt(int &value) const {
+	char buffer[32];
+
+	ssize_t length = readAtStart(buffer, sizeof(buffer) - 1);
+	if (length <= 0) {
+		return false;
+	}
+
+	buffer[length] = '\0';
+
+	char *end;
+	errno = 0;
+	long parsedValue = std::strtol(buffer, &end, 10);
+	if (end == buffer || errno != 0) {
+		return false;
+	}
+
+	value = static_cast<int>(parsedValue);
+	return true;
+}
+
+bool SysfsFile::writeInt(int value) const {
+	char buffer[32];
+	int bufferLength = std::snprintf(buffer, sizeof(buffer), "%d\n", value);
+
+	// sysfs takes the whole value from a single write at offset 0, a shorter value needs no truncation
+	return writeAtStart(buffer, bufferLength) == bufferLength;
+}
+
+const std::string &SysfsFile::getPath() const {
+	return path;
+}
+
+void SysfsFile::open() const {
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	do {
+		fd = ::open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+	} while (fd < 0 && errno == EINTR);
+}
+
+ssize_t SysfsFile::readAtStart(char *buffer, std::size_t size) const {
+	ssize_t length;
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		do {
+			length = pread(fd, buffer, size, 0);
+		} while (length < 0 && errno == EINTR);
+
+		if (length >= 0 || errno != ENODEV) {
+			break;
+		}
+		open();
+	}
+	return length;
+}
+
+ssize_t SysfsFile::writeAtStart(const char *buffer, std::size_t size) const {
+	ssize_t length;
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		do {
+			length = pwrite(fd, buffer, size, 0);
+		} while (length < 0 && errno == EINTR);
+
+		if (length >= 0 || errno != ENODEV) {
+			break;
+		}
+		open();
+	}
+	return length;
+}
+
+}
+}
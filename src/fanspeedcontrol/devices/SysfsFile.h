@@ -0,0 +1,58 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_DEVICES_SYSFSFILE_H_
+#define FANSPEEDCONTROL_DEVICES_SYSFSFILE_H_
+
+#include <cstddef>
+#include <string>
+
+#include <sys/types.h>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// sysfs attribute file, which is opened once and read and written at offset 0 without reopening,
+// it is only reopened if the file was removed with its device (ENODEV), e.g. by reloading the driver
+class SysfsFile {
+public:
+	SysfsFile(const std::string &path, bool writable);
+	virtual ~SysfsFile();
+
+	SysfsFile(const SysfsFile &) = delete;
+	SysfsFile &operator=(const SysfsFile &) = delete;
+
+	bool isOpen() const;
+	bool readInt(int &value) const;
+	bool writeInt(int value) const;
+	const std::string &getPath() const;
+
+private:
+	const std::string path;
+	const bool writable;
+	mutable int fd;
+
+	void open() const;
+	// retry once after reopening the file if its device is gone
+	ssize_t readAtStart(char *buffer, std::size_t size) const;
+	ssize_t writeAtStart(const char *buffer, std::size_t size) const;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_DEVICES_SYSFSFILE_H_ */
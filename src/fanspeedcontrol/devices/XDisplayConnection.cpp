@@ -0,0 +1,134 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "XDisplayConnection.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <X11/Xlib.h>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+const std::chrono::milliseconds XDisplayConnection::MIN_BACKOFF(1000);
+const std::chrono::milliseconds XDisplayConnection::MAX_BACKOFF(60000);
+
+std::mutex XDisplayConnection::connectionsMutex;
+std::map<std::string, std::weak_ptr<XDisplayConnection>> XDisplayConnection::connections;
+
+std::shared_ptr<XDisplayConnection> XDisplayConnection::getConnection(const std::string &displayName) {
+	std::lock_guard<std::mutex> lock(connectionsMutex);
+
+	std::shared_ptr<XDisplayConnection> connection = connections[displayName].lock();
+	if (!connection) {
+		connection = std::make_shared<XDisplayConnection>(displayName);
+		connections[displayName] = connection;
+	}
+
+	return connection;
+}
+
+XDisplayConnection::XDisplayConnection(const std::string &displayName)
+: displayName(displayName), backoff(MIN_BACKOFF), nextOpen(std::chrono::steady_clock::now()) {
+#ifdef HAVE_XSETIOERROREXITHANDLER
+	// a lost connection must not terminate the application, because then no device is set to automatic mode
+	XSetIOErrorHandler(handleIoError);
+#endif
+}
+
+XDisplayConnection::~XDisplayConnection() {
+	close();
+}
+
+const std::string &XDisplayConnection::getDisplayName() const {
+	return displayName;
+}
+
+Display *XDisplayConnection::getDisplay(bool ignoreBackoff) {
+	if (display) {
+		return display;
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (!ignoreBackoff && now < nextOpen) {
+		return nullptr;
+	}
+
+	display = XOpenDisplay(displayName.c_str());
+	if (!display) {
+		nextOpen = now + backoff;
+		backoff = std::min(backoff * 2, MAX_BACKOFF);
+		return nullptr;
+	}
+
+#ifdef HAVE_XSETIOERROREXITHANDLER
+	XSetIOErrorExitHandler(display, handleIoErrorExit, this);
+#endif
+
+	failures.clear();
+	ioErrorOccurred = false;
+	backoff = MIN_BACKOFF;
+	return display;
+}
+
+void XDisplayConnection::close() {
+	if (display) {
+		XCloseDisplay(display);
+		display = nullptr;
+		nextOpen = std::chrono::steady_clock::now() + backoff;
+	}
+}
+
+void XDisplayConnection::countResult(int target, bool succeeded) {
+	int &targetFailures = failures[target];
+	if (succeeded) {
+		targetFailures = 0;
+		return;
+	}
+
+	// a target which always fails, e.g. a wrong gpu id, must not close the display of the other targets
+	bool isRepeated = ++targetFailures >= MAX_FAILURES;
+	if (isRepeated) {
+		targetFailures = 0;
+	}
+
+	if (ioErrorOccurred || (isRepeated && !isResponding())) {
+		close();
+	}
+}
+
+bool XDisplayConnection::isResponding() {
+	XSync(display, False);
+	return !ioErrorOccurred;
+}
+
+int XDisplayConnection::handleIoError(Display *display) {
+	return 0;
+}
+
+void XDisplayConnection::handleIoErrorExit(Display *display, void *connection) {
+	// called by Xlib inside of a request, so the mutex of the connection is already locked
+	static_cast<XDisplayConnection *>(connection)->ioErrorOccurred = true;
+}
+
+}
+}
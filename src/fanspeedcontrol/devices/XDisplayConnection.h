@@ -0,0 +1,106 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_DEVICES_XDISPLAYCONNECTION_H_
+#define FANSPEEDCONTROL_DEVICES_XDISPLAYCONNECTION_H_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <X11/Xlib.h>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// connection to an x server, which is shared by all devices connected to the same display
+class XDisplayConnection {
+public:
+	static std::shared_ptr<XDisplayConnection> getConnection(const std::string &displayName);
+
+	XDisplayConnection(const std::string &displayName);
+	virtual ~XDisplayConnection();
+
+	// executes the request for target (e.g. the id of a gpu) with the locked display, the display is (re)opened
+	// lazily with a backoff, false is returned if the display is not open or the request fails,
+	// the display is closed if the connection is lost, but not if only the requests of one target fail
+	template <typename Request> bool request(int target, Request request, bool ignoreBackoff = false) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		Display *display = getDisplay(ignoreBackoff);
+		if (!display) {
+			return false;
+		}
+
+		bool succeeded = request(display);
+		countResult(target, succeeded);
+		return succeeded;
+	}
+
+	// like request, but a failure is not counted, e.g. for an attribute which is not supported by every driver
+	template <typename Request> bool requestOptional(Request request) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		Display *display = getDisplay(false);
+		if (!display) {
+			return false;
+		}
+
+		bool succeeded = request(display);
+		if (ioErrorOccurred) {
+			close();
+		}
+		return succeeded;
+	}
+
+	const std::string &getDisplayName() const;
+
+private:
+	static const int MAX_FAILURES = 5;
+	static const std::chrono::milliseconds MIN_BACKOFF;
+	static const std::chrono::milliseconds MAX_BACKOFF;
+
+	static std::mutex connectionsMutex;
+	static std::map<std::string, std::weak_ptr<XDisplayConnection>> connections;
+
+	const std::string displayName;
+
+	std::mutex mutex;
+	Display *display = nullptr;
+	// consecutive failed requests per target since the display was opened
+	std::map<int, int> failures;
+	bool ioErrorOccurred = false;
+	std::chrono::milliseconds backoff;
+	std::chrono::steady_clock::time_point nextOpen;
+
+	Display *getDisplay(bool ignoreBackoff);
+	void close();
+	// closes the display after an io error or if a target fails MAX_FAILURES times and the server does not answer
+	void countResult(int target, bool succeeded);
+	// a round trip to the server, which sets ioErrorOccurred if the connection is lost
+	bool isResponding();
+
+	static int handleIoError(Display *display);
+	static void handleIoErrorExit(Display *display, void *connection);
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_DEVICES_XDISPLAYCONNECTION_H_ */
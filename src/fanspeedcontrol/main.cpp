@@ -15,28 +15,43 @@
 // You should have received a copy of the GNU General Public License
 // along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
 
-#include <chrono>
+#include <atomic>
 #include <csignal>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
-#include <thread>
 #include <variant>
-#include <vector>
 
-#include <boost/interprocess/sync/named_mutex.hpp>
+#include <boost/format.hpp>
 #include <boost/program_options.hpp>
 #include <libintl.h>
 
 #include "config/ArgsAndConfigProcessor.h"
+#include "config/ConfigReloader.h"
+#include "control/ControlLoop.h"
+#include "control/ControlServer.h"
 #include "devices/AbstractDevice.h"
 
-const std::chrono::milliseconds MAX_SLEEP_TIME(100);
+// the flag is also read by the worker threads, therefore it must be lock free to be set in a signal handler
+static_assert(ATOMIC_BOOL_LOCK_FREE == 2, "std::atomic<bool> must be lock free");
+std::atomic<bool> appStopFlag(false);
 
-sig_atomic_t appStopFlag = 0;
+// requests a report of the latencies of the control loop
+std::atomic<bool> appReportFlag(false);
+
+// requests a reload of the configuration file
+std::atomic<bool> appReloadFlag(false);
 
 void setAppStopFlag(int signal) {
-	appStopFlag = 1;
+	appStopFlag = true;
+}
+
+void setAppReportFlag(int signal) {
+	appReportFlag = true;
+}
+
+void setAppReloadFlag(int signal) {
+	appReloadFlag = true;
 }
 
 int main(int argc, char *argv[]) {
@@ -54,53 +69,52 @@ int main(int argc, char *argv[]) {
 
 	std::signal(SIGTERM, setAppStopFlag);
 	std::signal(SIGINT, setAppStopFlag);
-
-	boost::interprocess::named_mutex mutex(boost::interprocess::open_or_create,
-			msc42::fanspeedcontrol::DOMAIN_NAME.c_str());
-	if (!mutex.try_lock()) {
-		std::cout << gettext("Cannot start this fanspeedcontrol instance, "
-				"because another instance has locked starting new instances.\n"
-				"Terminate running instance to start a new instance.\n"
-				"If you are sure, that no other instance is running, remove the lock with the option --remove-lock "
-				"if you are not sure, but you want to start a new fanspeedcontrol instance, restart your system "
-				"to terminate the possible running instance and remove the lock.\n"
-				"Wrong usage of the option remove-lock can overheat your system.") << std::endl;
-		return EXIT_FAILURE;
-	}
+	std::signal(SIGUSR1, setAppReportFlag);
+	std::signal(SIGHUP, setAppReloadFlag);
 
 	for (const std::unique_ptr<msc42::fanspeedcontrol::AbstractDevice> &device : configuration.devices) {
 		device->notifyObservers(msc42::fanspeedcontrol::AbstractDevice::DEVICE_CONFIG, device->to_string(true));
 	}
 
 	try {
-		while (appStopFlag == 0) {
-			std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-
-			for (const std::unique_ptr<msc42::fanspeedcontrol::AbstractDevice> &device : configuration.devices) {
-				device->setOptimalFanSpeed();
+		msc42::fanspeedcontrol::ConfigReloader configReloader(configuration.configurationPath,
+				configuration.interval.count(), configuration.fileConfiguration, configuration.snapshot,
+				configuration.devices, appReloadFlag);
+
+		std::unique_ptr<msc42::fanspeedcontrol::ControlServer> controlServer;
+		if (!configuration.controlSocketPath.empty()) {
+			controlServer = msc42::fanspeedcontrol::ControlServer::createUnixSocketServer(
+					configuration.controlSocketPath, configuration.devices, configuration.metrics);
+
+			if (!controlServer) {
+				std::cout << gettext("Cannot create the socket of the control server.") << std::endl;
+				return EXIT_FAILURE;
 			}
+		}
 
-			// sleep max MAX_SLEEP_TIME milliseconds to ensure to have enough time to call the destructor
-			// between sigterm and sigkill by system shutdown
-			bool notLastThreadSleepInThisIteration = true;
-			while (notLastThreadSleepInThisIteration && appStopFlag == 0) {
-				std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-				std::chrono::milliseconds processingTime =
-						std::chrono::duration_cast<std::chrono::milliseconds>(now - begin);
-
-				if (configuration.interval - processingTime >= MAX_SLEEP_TIME) {
-					std::this_thread::sleep_for(MAX_SLEEP_TIME);
-				} else {
-					std::this_thread::sleep_for(configuration.interval - processingTime);
-					notLastThreadSleepInThisIteration = false;
-				}
-			}
+		msc42::fanspeedcontrol::ControlLoop controlLoop(configuration.devices, appStopFlag, appReportFlag,
+				configuration.clock, configuration.metrics, configuration.watchdog,
+				configuration.history);
+
+		if (configuration.watchdog && !configuration.watchdog->watchDevices(configuration.devices.size())) {
+			std::cout << boost::format(gettext("The watchdog cannot watch %d devices.")) % configuration.devices.size()
+					<< std::endl;
+			return EXIT_FAILURE;
 		}
 
-		mutex.unlock();
+		if (configuration.parallel) {
+			controlLoop.runParallel();
+		} else {
+			controlLoop.runSequential();
+		}
 	} catch (...) {
 		// catch all exceptions because it is important to call destructor of a device if temperature is set once
 	}
 
+	// stopping the devices can take longer than the timeout of the watchdog
+	if (configuration.watchdog) {
+		configuration.watchdog->watchDevices(0);
+	}
+
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,312 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "History.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+const char HISTORY_MAGIC[8] = {'F', 'S', 'C', 'H', 'I', 'S', 'T', '\0'};
+const std::size_t HISTORY_TYPE_LENGTH = 24;
+
+// the integers are stored in the byte order of the machine
+struct HistoryHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t deviceCount;
+	std::uint32_t capacity;
+	std::uint32_t periodMilliseconds;
+	char reserved[40];
+};
+
+struct HistoryDeviceHeader {
+	// zero padded, truncated if longer
+	char type[HISTORY_TYPE_LENGTH];
+	std::int32_t id;
+	char reserved[4];
+};
+
+static_assert(sizeof(HistoryHeader) == 64 && sizeof(HistoryDeviceHeader) == 32,
+		"the headers must have the size of the file format");
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t)
+		&& std::atomic<std::uint32_t>::is_always_lock_free, "a sample must be written by a single store");
+
+// a sample has 32 bits: bits 0 to 6 the temperature, bits 7 to 13 the fan speed, bits 14 and 15 the mode,
+// bits 16 to 30 the lowest bits of the lap, which is the number of the period divided by the capacity,
+// so that a sample of an earlier lap is not taken as recent, and bit 31 is set for every written sample
+const std::uint32_t SAMPLE_UNKNOWN_VALUE = 127;
+const std::uint32_t SAMPLE_LAP_MASK = 0x7FFF;
+const std::uint32_t SAMPLE_SET = 1u << 31;
+
+enum SampleMode : std::uint32_t {
+	SAMPLE_MODE_CURVE,
+	SAMPLE_MODE_AUTOMATIC,
+	SAMPLE_MODE_OVERRIDE_FAN_SPEED,
+	SAMPLE_MODE_OVERRIDE_AUTOMATIC_MODE
+};
+
+const char *getSampleModeName(std::uint32_t mode) {
+	switch (mode) {
+	case SAMPLE_MODE_AUTOMATIC:
+		return "automatic";
+	case SAMPLE_MODE_OVERRIDE_FAN_SPEED:
+		return "overrideFanSpeed";
+	case SAMPLE_MODE_OVERRIDE_AUTOMATIC_MODE:
+		return "overrideAutomaticMode";
+	default:
+		return "curve";
+	}
+}
+
+std::uint32_t encodeSampleValue(int value, int min, int max) {
+	return value >= min && value <= max ? value : SAMPLE_UNKNOWN_VALUE;
+}
+
+std::size_t getSamplesOffset(std::size_t deviceCount) {
+	return sizeof(HistoryHeader) + deviceCount * sizeof(HistoryDeviceHeader);
+}
+
+std::int64_t getPeriodNumber(std::int64_t periodMilliseconds) {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count() / periodMilliseconds;
+}
+
+std::unique_ptr<History> History::open(const std::string &path,
+		const std::vector<std::unique_ptr<AbstractDevice>> &devices, const std::chrono::milliseconds &period,
+		std::size_t capacity) {
+	if (devices.empty() || period.count() <= 0 || capacity == 0 || capacity > UINT32_MAX) {
+		return std::unique_ptr<History>();
+	}
+
+	// the headers, which the file must begin with to be reused
+	std::vector<char> headers(getSamplesOffset(devices.size()), 0);
+
+	HistoryHeader *header = reinterpret_cast<HistoryHeader *>(headers.data());
+	std::memcpy(header->magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+	header->version = HISTORY_FORMAT_VERSION;
+	header->deviceCount = devices.size();
+	header->capacity = capacity;
+	header->periodMilliseconds = period.count();
+
+	HistoryDeviceHeader *deviceHeaders = reinterpret_cast<HistoryDeviceHeader *>(header + 1);
+	for (std::size_t i = 0; i < devices.size(); ++i) {
+		devices[i]->getType().copy(deviceHeaders[i].type, HISTORY_TYPE_LENGTH);
+		deviceHeaders[i].id = devices[i]->getId();
+	}
+
+	const std::size_t mapSize = headers.size() + devices.size() * capacity * sizeof(std::uint32_t);
+
+	int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0644);
+	if (fd < 0) {
+		return std::unique_ptr<History>();
+	}
+
+	struct stat status;
+	std::vector<char> existingHeaders(headers.size());
+	bool reusable = fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) == mapSize
+			&& pread(fd, existingHeaders.data(), existingHeaders.size(), 0)
+					== static_cast<ssize_t>(existingHeaders.size())
+			&& existingHeaders == headers;
+
+	// the file is emptied and extended, so that the samples are zero without writing them
+	if (!reusable && (ftruncate(fd, 0) != 0 || ftruncate(fd, mapSize) != 0
+			|| pwrite(fd, headers.data(), headers.size(), 0) != static_cast<ssize_t>(headers.size()))) {
+		close(fd);
+		return std::unique_ptr<History>();
+	}
+
+	void *map = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		return std::unique_ptr<History>();
+	}
+
+	return std::unique_ptr<History>(new History(map, mapSize, devices.size(), period.count(), capacity));
+}
+
+History::History(void *map, std::size_t mapSize, std::size_t deviceCount, std::int64_t periodMilliseconds,
+		std::size_t capacity)
+: map(map), mapSize(mapSize), deviceCount(deviceCount), periodMilliseconds(periodMilliseconds),
+  capacity(capacity),
+  samples(reinterpret_cast<std::atomic<std::uint32_t> *>(static_cast<char *>(map) + getSamplesOffset(deviceCount))) {
+}
+
+History::~History() {
+	// the kernel writes the pages back to the file, also after a crash
+	munmap(map, mapSize);
+}
+
+void History::record(std::size_t index, const AbstractDevice &device) {
+	if (index >= deviceCount) {
+		return;
+	}
+
+	std::uint32_t mode = SAMPLE_MODE_CURVE;
+	if (device.getActiveOverride() == AbstractDevice::OVERRIDE_FAN_SPEED) {
+		mode = SAMPLE_MODE_OVERRIDE_FAN_SPEED;
+	} else if (device.getActiveOverride() == AbstractDevice::OVERRIDE_AUTOMATIC_MODE) {
+		mode = SAMPLE_MODE_OVERRIDE_AUTOMATIC_MODE;
+	} else if (device.isAutomaticMode()) {
+		mode = SAMPLE_MODE_AUTOMATIC;
+	}
+
+	std::int64_t periodNumber = getPeriodNumber(periodMilliseconds);
+	std::uint32_t lap = periodNumber / capacity;
+
+	std::uint32_t sample = encodeSampleValue(device.getLastTemperature(), MIN_TEMPERATURE_VALID, MAX_TEMPERATURE_VALID)
+			| encodeSampleValue(device.getCurrentFanSpeed(), MIN_FAN_SPEED, MAX_FAN_SPEED) << 7
+			| mode << 14 | (lap & SAMPLE_LAP_MASK) << 16 | SAMPLE_SET;
+
+	samples[index * capacity + periodNumber % capacity].store(sample, std::memory_order_relaxed);
+}
+
+bool History::dump(const std::string &path, Format format, std::ostream &output) {
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(HistoryHeader)) {
+		close(fd);
+		return false;
+	}
+
+	const std::size_t mapSize = status.st_size;
+	void *map = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		return false;
+	}
+
+	const HistoryHeader *header = static_cast<const HistoryHeader *>(map);
+	const std::size_t deviceCount = header->deviceCount;
+	const std::size_t capacity = header->capacity;
+	const std::int64_t periodMilliseconds = header->periodMilliseconds;
+
+	if (std::memcmp(header->magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC)) != 0
+			|| header->version != HISTORY_FORMAT_VERSION || periodMilliseconds <= 0 || capacity == 0
+			|| mapSize != getSamplesOffset(deviceCount) + deviceCount * capacity * sizeof(std::uint32_t)) {
+		munmap(map, mapSize);
+		return false;
+	}
+
+	const HistoryDeviceHeader *deviceHeaders = reinterpret_cast<const HistoryDeviceHeader *>(header + 1);
+	const std::atomic<std::uint32_t> *samples = reinterpret_cast<const std::atomic<std::uint32_t> *>(
+			static_cast<const char *>(map) + getSamplesOffset(deviceCount));
+
+	const std::int64_t lastPeriodNumber = getPeriodNumber(periodMilliseconds);
+
+	if (format == FORMAT_CSV) {
+		output << "index,type,id,time,temperature,fanSpeed,mode\n";
+	} else {
+		output << "{\"version\":" << HISTORY_FORMAT_VERSION << ", \"period\":" << periodMilliseconds
+				<< ", \"devices\":[";
+	}
+
+	for (std::size_t i = 0; i < deviceCount; ++i) {
+		const std::string type(deviceHeaders[i].type, strnlen(deviceHeaders[i].type, HISTORY_TYPE_LENGTH));
+		const int id = deviceHeaders[i].id;
+
+		if (format == FORMAT_JSON) {
+			output << (i > 0 ? ", " : "") << "{\"index\":" << i << ", \"type\":\"" << type << "\", \"id\":" << id
+					<< ", \"samples\":[";
+		}
+
+		bool notFirstSample = false;
+		for (std::int64_t periodNumber = lastPeriodNumber - static_cast<std::int64_t>(capacity) + 1;
+				periodNumber <= lastPeriodNumber; ++periodNumber) {
+			if (periodNumber < 0) {
+				continue;
+			}
+
+			std::uint32_t sample = samples[i * capacity + periodNumber % capacity].load(std::memory_order_relaxed);
+			std::uint32_t lap = periodNumber / capacity;
+
+			if (!(sample & SAMPLE_SET) || (sample >> 16 & SAMPLE_LAP_MASK) != (lap & SAMPLE_LAP_MASK)) {
+				continue;
+			}
+
+			std::uint32_t temperature = sample & 0x7F;
+			std::uint32_t fanSpeed = sample >> 7 & 0x7F;
+			const char *mode = getSampleModeName(sample >> 14 & 0x3);
+			std::int64_t time = periodNumber * periodMilliseconds;
+
+			// an unknown temperature or fan speed is empty in csv and null in json
+			if (format == FORMAT_CSV) {
+				output << i << "," << type << "," << id << "," << time << ",";
+				if (temperature != SAMPLE_UNKNOWN_VALUE) {
+					output << temperature;
+				}
+				output << ",";
+				if (fanSpeed != SAMPLE_UNKNOWN_VALUE) {
+					output << fanSpeed;
+				}
+				output << "," << mode << "\n";
+			} else {
+				output << (notFirstSample ? ",\n" : "\n") << "{\"time\":" << time << ", \"temperature\":";
+				if (temperature != SAMPLE_UNKNOWN_VALUE) {
+					output << temperature;
+				} else {
+					output << "null";
+				}
+				output << ", \"fanSpeed\":";
+				if (fanSpeed != SAMPLE_UNKNOWN_VALUE) {
+					output << fanSpeed;
+				} else {
+					output << "null";
+				}
+				output << ", \"mode\":\"" << mode << "\"}";
+				notFirstSample = true;
+			}
+		}
+
+		if (format == FORMAT_JSON) {
+			output << "]}";
+		}
+	}
+
+	if (format == FORMAT_JSON) {
+		output << "]}\n";
+	}
+
+	munmap(map, mapSize);
+	return static_cast<bool>(output);
+}
+
+}
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef FANSPEEDCONTROL_METRICS_HISTORY_H_
+#define FANSPEEDCONTROL_METRICS_HISTORY_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// version of the file format, a file with another version is replaced
+const std::uint32_t HISTORY_FORMAT_VERSION = 1;
+
+// temperature and fan speed of every device over the last days in a file, which is mapped into the memory,
+// so that it survives restarts and a sample is written by a single store without a system call,
+// the file has a header, a header per device and a ring of samples per device,
+// the slot of a sample is given by its time: the wall clock time divided by the period modulo the capacity,
+// so that no write position is stored, the sample of the last tick of a period is kept
+class History {
+public:
+	enum Format {
+		FORMAT_CSV,
+		FORMAT_JSON
+	};
+
+	// the file is reused if it was created for the same devices, period and capacity, otherwise it is replaced,
+	// returns an empty pointer if the file cannot be created or mapped
+	static std::unique_ptr<History> open(const std::string &path,
+			const std::vector<std::unique_ptr<AbstractDevice>> &devices, const std::chrono::milliseconds &period,
+			std::size_t capacity);
+
+	// writes the samples of the last capacity periods in the order of their time, the file can be used by
+	// a running instance, returns false if the file cannot be read or has another format
+	static bool dump(const std::string &path, Format format, std::ostream &output);
+
+	virtual ~History();
+
+	History(const History &) = delete;
+	History &operator=(const History &) = delete;
+
+	// called by the thread, which controls the device, after every control of the device
+	void record(std::size_t index, const AbstractDevice &device);
+
+private:
+	History(void *map, std::size_t mapSize, std::size_t deviceCount, std::int64_t periodMilliseconds,
+			std::size_t capacity);
+
+	void *const map;
+	const std::size_t mapSize;
+	const std::size_t deviceCount;
+	const std::int64_t periodMilliseconds;
+	const std::size_t capacity;
+	// samples of all devices, capacity samples per device
+	std::atomic<std::uint32_t> *const samples;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_METRICS_HISTORY_H_ */
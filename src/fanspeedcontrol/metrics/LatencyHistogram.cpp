@@ -0,0 +1,113 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+LatencyHistogram::LatencyHistogram()
+: count(0), max(0) {
+	for (std::atomic<unsigned long> &bucketCount : counts) {
+		bucketCount.store(0, std::memory_order_relaxed);
+	}
+}
+
+void LatencyHistogram::record(const std::chrono::steady_clock::duration &duration) {
+	long long nanoseconds = std::max<long long>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0);
+
+	counts[getBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+
+	// only the recording thread writes the maximum, so no compare and swap is needed
+	if (nanoseconds > max.load(std::memory_order_relaxed)) {
+		max.store(nanoseconds, std::memory_order_relaxed);
+	}
+}
+
+unsigned long LatencyHistogram::getCount() const {
+	return count.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMax() const {
+	return std::chrono::nanoseconds(max.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds LatencyHistogram::getPercentile(double percentile) const {
+	unsigned long total = 0;
+	for (const std::atomic<unsigned long> &bucketCount : counts) {
+		total += bucketCount.load(std::memory_order_relaxed);
+	}
+
+	if (total == 0) {
+		return std::chrono::nanoseconds(0);
+	}
+
+	unsigned long rank = std::max<unsigned long>(
+			static_cast<unsigned long>(std::ceil(std::min(std::max(percentile, 0.0), 100.0) / 100 * total)), 1);
+
+	unsigned long cumulative = 0;
+	for (std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+		cumulative += counts[bucket].load(std::memory_order_relaxed);
+		if (cumulative >= rank) {
+			// the last bucket has no upper bound
+			if (bucket == BUCKET_COUNT - 1) {
+				return getMax();
+			}
+			// the bucket bound can be above the largest recorded value
+			return std::min(std::chrono::nanoseconds(getUpperBound(bucket)), getMax());
+		}
+	}
+
+	return getMax();
+}
+
+std::size_t LatencyHistogram::getBucket(unsigned long long value) {
+	if (value < 2 * SUB_BUCKET_COUNT) {
+		return value;
+	}
+
+	int highestBit = 63 - __builtin_clzll(value);
+	if (highestBit >= MAX_VALUE_BITS) {
+		return BUCKET_COUNT - 1;
+	}
+
+	int shift = highestBit - SUB_BUCKET_BITS;
+	std::size_t subBucket = (value >> shift) - SUB_BUCKET_COUNT;
+	return 2 * SUB_BUCKET_COUNT + (highestBit - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+unsigned long long LatencyHistogram::getUpperBound(std::size_t bucket) {
+	if (bucket < 2 * SUB_BUCKET_COUNT) {
+		return bucket;
+	}
+
+	int highestBit = (bucket - 2 * SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT + SUB_BUCKET_BITS + 1;
+	unsigned long long subBucket = (bucket - 2 * SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+	int shift = highestBit - SUB_BUCKET_BITS;
+	return ((SUB_BUCKET_COUNT + subBucket + 1) << shift) - 1;
+}
+
+}
+}
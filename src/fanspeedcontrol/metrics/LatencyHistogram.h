@@ -0,0 +1,62 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_METRICS_LATENCYHISTOGRAM_H_
+#define FANSPEEDCONTROL_METRICS_LATENCYHISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// histogram with logarithmic buckets, which are divided into linear sub-buckets like a hdr histogram,
+// durations up to 2^40 nanoseconds (about 18 minutes) are recorded with a relative error below 1/16,
+// it has a fixed size and does not allocate, one thread records and other threads can read at the same time
+class LatencyHistogram {
+public:
+	static const int SUB_BUCKET_BITS = 4;
+	static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+	static const int MAX_VALUE_BITS = 40;
+	// values below 2 * SUB_BUCKET_COUNT get an exact bucket, every further power of two gets SUB_BUCKET_COUNT buckets
+	static const std::size_t BUCKET_COUNT = 2 * SUB_BUCKET_COUNT
+			+ (MAX_VALUE_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT;
+
+	LatencyHistogram();
+
+	void record(const std::chrono::steady_clock::duration &duration);
+
+	unsigned long getCount() const;
+	std::chrono::nanoseconds getMax() const;
+	// upper bound of the bucket containing the percentile (between 0 and 100)
+	std::chrono::nanoseconds getPercentile(double percentile) const;
+
+private:
+	std::array<std::atomic<unsigned long>, BUCKET_COUNT> counts;
+	std::atomic<unsigned long> count;
+	std::atomic<long long> max;
+
+	static std::size_t getBucket(unsigned long long value);
+	static unsigned long long getUpperBound(std::size_t bucket);
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_METRICS_LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,195 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "patterns/observer/AsyncObserver.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+Metrics::Metrics(const std::vector<std::unique_ptr<AbstractDevice>> &devices)
+: size(devices.size()), deviceMetrics(new DeviceMetrics[devices.size()]) {
+	for (std::size_t i = 0; i < size; ++i) {
+		deviceMetrics[i].type = devices[i]->getType();
+		deviceMetrics[i].id = devices[i]->getId();
+	}
+}
+
+void Metrics::recordTick(std::size_t index, const AbstractDevice &device,
+		const std::chrono::steady_clock::duration &duration) {
+	if (index >= size) {
+		return;
+	}
+
+	DeviceMetrics &metrics = deviceMetrics[index];
+	metrics.temperature.store(device.getLastTemperature(), std::memory_order_relaxed);
+	metrics.fanSpeed.store(device.getCurrentFanSpeed(), std::memory_order_relaxed);
+	metrics.automaticMode.store(device.isAutomaticMode(), std::memory_order_relaxed);
+	metrics.override.store(device.getActiveOverride(), std::memory_order_relaxed);
+	metrics.pollIntervalMilliseconds.store(device.getPollInterval().count(), std::memory_order_relaxed);
+	metrics.avoidedWriteCount.store(device.getAvoidedWrites(), std::memory_order_relaxed);
+
+	double seconds = std::chrono::duration<double>(duration).count();
+	std::size_t bucket = 0;
+	while (bucket < TICK_DURATION_BUCKETS.size() && seconds > TICK_DURATION_BUCKETS[bucket]) {
+		++bucket;
+	}
+
+	metrics.tickBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	metrics.tickNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+			std::memory_order_relaxed);
+}
+
+void Metrics::countEvent(std::size_t index, int messageId) {
+	if (index >= size) {
+		return;
+	}
+
+	DeviceMetrics &metrics = deviceMetrics[index];
+
+	switch (messageId) {
+
+	case AbstractDevice::FAN_SET:
+		metrics.fanSetCount.fetch_add(1, std::memory_order_relaxed);
+		break;
+
+	case AbstractDevice::FAN_SET_ERROR:
+		metrics.fanSetErrorCount.fetch_add(1, std::memory_order_relaxed);
+		break;
+
+	case AbstractDevice::TEMPERATUR_READ_ERROR:
+		metrics.temperatureReadErrorCount.fetch_add(1, std::memory_order_relaxed);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void Metrics::setObserverQueue(const std::shared_ptr<msc42::patterns::AsyncObserver> &asyncObserver) {
+	this->asyncObserver = asyncObserver;
+}
+
+std::string Metrics::render() const {
+	std::stringstream s;
+
+	const auto labels = [](const DeviceMetrics &metrics) {
+		return "type=\"" + metrics.type + "\",id=\"" + std::to_string(metrics.id) + "\"";
+	};
+
+	s << "# HELP fanspeedcontrol_temperature_celsius Last read temperature of the device.\n"
+			<< "# TYPE fanspeedcontrol_temperature_celsius gauge\n";
+	for (std::size_t i = 0; i < size; ++i) {
+		s << "fanspeedcontrol_temperature_celsius{" << labels(deviceMetrics[i]) << "} "
+				<< deviceMetrics[i].temperature.load(std::memory_order_relaxed) << "\n";
+	}
+
+	s << "# HELP fanspeedcontrol_fan_speed_percent Fan speed set by fanspeedcontrol, -1 in automatic mode.\n"
+			<< "# TYPE fanspeedcontrol_fan_speed_percent gauge\n";
+	for (std::size_t i = 0; i < size; ++i) {
+		s << "fanspeedcontrol_fan_speed_percent{" << labels(deviceMetrics[i]) << "} "
+				<< deviceMetrics[i].fanSpeed.load(std::memory_order_relaxed) << "\n";
+	}
+
+	s << "# HELP fanspeedcontrol_automatic_mode 1 if the fan is controlled by the device itself.\n"
+			<< "# TYPE fanspeedcontrol_automatic_mode gauge\n";
+	for (std::size_t i = 0; i < size; ++i) {
+		s << "fanspeedcontrol_automatic_mode{" << labels(deviceMetrics[i]) << "} "
+				<< deviceMetrics[i].automaticMode.load(std::memory_order_relaxed) << "\n";
+	}
+
+	s << "# HELP fanspeedcontrol_fan_set_total Number of successfully set fan speeds.\n"
+			<< "# TYPE fanspeedcontrol_fan_set_total counter\n";
+	for (std::size_t i = 0; i < size; ++i) {
+		s << "fanspeedcontrol_fan_set_total{" << labels(deviceMetrics[i]) << "} "
+				<< deviceMetrics[i].fanSetCount.load(std::memory_order_relaxed) << "\n";
+	}
+
+	s << "# HELP fanspeedcontrol_fan_set_errors_total Number of failed attempts to set the fan speed.\n"
+			<< "# TYPE fanspeedcontrol_fan_set_errors_total counter\n";
+	for (std::size_t i = 0; i < size; ++i) {
+		s << "fanspeedcontrol_fan_set_errors_total{" << labels(deviceMetrics[i]) << "} "
+				<< deviceMetrics[i].fanSetErrorCount.load(std::memory_order_relaxed) << "\n";
+	}
+
+	s << "# HELP fanspeedcontrol_temperature_read_errors_total Number of invalid temperature readings.\n"
+			<< "# TYPE fanspeedcontrol_temperature_read_errors_total counter\n";
+	for (std::size_t i = 0; i < size; ++i) {
+		s << "fanspeedcontrol_temperature_read_errors_total{" << labels(deviceMetrics[i]) << "} "
+				<< deviceMetrics[i].temperatureReadErrorCount.load(std::memory_order_relaxed) << "\n";
+	}
+
+	s << "# HELP fanspeedcontrol_avoided_writes_total Number of fan speed and mode writes which were not necessary.\n"
+			<< "# TYPE fanspeedcontrol_avoided_writes_total counter\n";
+	for (std::size_t i = 0; i < size; ++i) {
+		s << "fanspeedcontrol_avoided_writes_total{" << labels(deviceMetrics[i]) << "} "
+				<< deviceMetrics[i].avoidedWriteCount.load(std::memory_order_relaxed) << "\n";
+	}
+
+	s << "# HELP fanspeedcontrol_tick_duration_seconds Duration of reading the temperature and setting the fan.\n"
+			<< "# TYPE fanspeedcontrol_tick_duration_seconds histogram\n";
+	for (std::size_t i = 0; i < size; ++i) {
+		const DeviceMetrics &metrics = deviceMetrics[i];
+
+		// the buckets are stored separately and are accumulated only for the output
+		unsigned long cumulative = 0;
+		for (std::size_t bucket = 0; bucket < TICK_DURATION_BUCKETS.size(); ++bucket) {
+			cumulative += metrics.tickBuckets[bucket].load(std::memory_order_relaxed);
+			s << "fanspeedcontrol_tick_duration_seconds_bucket{" << labels(metrics) << ",le=\""
+					<< TICK_DURATION_BUCKETS[bucket] << "\"} " << cumulative << "\n";
+		}
+		cumulative += metrics.tickBuckets[TICK_DURATION_BUCKETS.size()].load(std::memory_order_relaxed);
+		s << "fanspeedcontrol_tick_duration_seconds_bucket{" << labels(metrics) << ",le=\"+Inf\"} "
+				<< cumulative << "\n";
+		s << "fanspeedcontrol_tick_duration_seconds_sum{" << labels(metrics) << "} "
+				<< metrics.tickNanoseconds.load(std::memory_order_relaxed) / 1e9 << "\n";
+		// the count is the sum of the buckets, so that it is consistent with the buckets
+		s << "fanspeedcontrol_tick_duration_seconds_count{" << labels(metrics) << "} " << cumulative << "\n";
+	}
+
+	if (asyncObserver) {
+		s << "# HELP fanspeedcontrol_observer_queue_depth Number of events waiting for the observers.\n"
+				<< "# TYPE fanspeedcontrol_observer_queue_depth gauge\n"
+				<< "fanspeedcontrol_observer_queue_depth " << asyncObserver->getQueueDepth() << "\n";
+		s << "# HELP fanspeedcontrol_observer_dropped_events_total Number of events dropped by a full queue.\n"
+				<< "# TYPE fanspeedcontrol_observer_dropped_events_total counter\n"
+				<< "fanspeedcontrol_observer_dropped_events_total " << asyncObserver->getDroppedCount() << "\n";
+	}
+
+	return s.str();
+}
+
+std::size_t Metrics::getDeviceCount() const {
+	return size;
+}
+
+const DeviceMetrics &Metrics::getDeviceMetrics(std::size_t index) const {
+	return deviceMetrics[index];
+}
+
+}
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_METRICS_METRICS_H_
+#define FANSPEEDCONTROL_METRICS_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "patterns/observer/AsyncObserver.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// upper bounds of the tick duration histogram in seconds
+const std::array<double, 12> TICK_DURATION_BUCKETS = {
+		0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 1};
+
+// values of a device, written by the thread which controls the device and read by the metrics server,
+// every value is a relaxed atomic, so that neither side waits for the other
+struct DeviceMetrics {
+	std::string type;
+	int id = 0;
+
+	std::atomic<int> temperature{-1};
+	std::atomic<int> fanSpeed{-1};
+	std::atomic<bool> automaticMode{false};
+	std::atomic<int> override{AbstractDevice::OVERRIDE_NONE};
+	std::atomic<long> pollIntervalMilliseconds{0};
+
+	std::atomic<unsigned long> fanSetCount{0};
+	std::atomic<unsigned long> fanSetErrorCount{0};
+	std::atomic<unsigned long> temperatureReadErrorCount{0};
+	std::atomic<unsigned long> avoidedWriteCount{0};
+
+	// the last bucket counts ticks above the largest bound
+	std::array<std::atomic<unsigned long>, TICK_DURATION_BUCKETS.size() + 1> tickBuckets{};
+	std::atomic<unsigned long long> tickNanoseconds{0};
+};
+
+class Metrics {
+public:
+	Metrics(const std::vector<std::unique_ptr<AbstractDevice>> &devices);
+
+	void recordTick(std::size_t index, const AbstractDevice &device, const std::chrono::steady_clock::duration &duration);
+	void countEvent(std::size_t index, int messageId);
+	void setObserverQueue(const std::shared_ptr<msc42::patterns::AsyncObserver> &asyncObserver);
+
+	// text exposition format of prometheus
+	std::string render() const;
+
+	std::size_t getDeviceCount() const;
+	// values of the last tick of the device, e.g. for the control server
+	const DeviceMetrics &getDeviceMetrics(std::size_t index) const;
+
+private:
+	const std::size_t size;
+	std::unique_ptr<DeviceMetrics[]> deviceMetrics;
+	std::shared_ptr<msc42::patterns::AsyncObserver> asyncObserver;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_METRICS_METRICS_H_ */
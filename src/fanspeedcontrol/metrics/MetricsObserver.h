@@ -0,0 +1,47 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_METRICS_METRICSOBSERVER_H_
+#define FANSPEEDCONTROL_METRICS_METRICSOBSERVER_H_
+
+#include <memory>
+#include <string>
+
+#include "Metrics.h"
+#include "patterns/observer/AbstractObserver.h"
+#include "patterns/observer/Event.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// counts the events of the devices, it only increments atomic counters,
+// so that it can be called directly by the control threads
+class MetricsObserver: public msc42::patterns::AbstractObserver {
+public:
+	MetricsObserver(const std::shared_ptr<Metrics> &metrics);
+	virtual ~MetricsObserver();
+	virtual bool notify(int messageId, const std::string &message1 = "", const std::string &message2 = "");
+	virtual bool notify(const msc42::patterns::Event &event);
+
+private:
+	const std::shared_ptr<Metrics> metrics;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_METRICS_METRICSOBSERVER_H_ */
@@ -0,0 +1,210 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "MetricsServer.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "Metrics.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// the server checks the stop flag at least every POLL_TIMEOUT
+const int POLL_TIMEOUT_MILLISECONDS = 100;
+// a client which does not send its request in time is disconnected
+const int CLIENT_TIMEOUT_SECONDS = 1;
+const int LISTEN_BACKLOG = 4;
+
+bool isStaleUnixSocket(const sockaddr_un &address) {
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return false;
+	}
+
+	bool stale = connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+			&& errno == ECONNREFUSED;
+	close(fd);
+	return stale;
+}
+
+// if ownerOnly, the socket file is created with the mode 0600 by the umask instead of changed after the bind,
+// so that no other user can connect in between
+bool bindUnixSocket(int fd, const sockaddr_un &address, bool ownerOnly) {
+	mode_t previousMask = ownerOnly ? umask(S_IXUSR | S_IRWXG | S_IRWXO) : 0;
+	bool bound = bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0;
+	if (ownerOnly) {
+		int bindError = errno;
+		umask(previousMask);
+		errno = bindError;
+	}
+	return bound;
+}
+
+int listenOnUnixSocket(const std::string &path, bool ownerOnly) {
+	sockaddr_un address = sockaddr_un();
+	if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+		return -1;
+	}
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return -1;
+	}
+
+	bool bound = bindUnixSocket(fd, address, ownerOnly);
+
+	// the socket file of a crashed instance is replaced, a socket which accepts connections is not touched
+	if (!bound && errno == EADDRINUSE && isStaleUnixSocket(address)) {
+		unlink(path.c_str());
+		bound = bindUnixSocket(fd, address, ownerOnly);
+	}
+
+	if (!bound || listen(fd, LISTEN_BACKLOG) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+std::unique_ptr<MetricsServer> MetricsServer::createUnixSocketServer(const std::string &path,
+		const std::shared_ptr<Metrics> &metrics) {
+	int fd = listenOnUnixSocket(path);
+	if (fd < 0) {
+		return std::unique_ptr<MetricsServer>();
+	}
+
+	return std::unique_ptr<MetricsServer>(new MetricsServer(fd, path, metrics));
+}
+
+std::unique_ptr<MetricsServer> MetricsServer::createLoopbackServer(int port, const std::shared_ptr<Metrics> &metrics) {
+	if (port <= 0 || port > 65535) {
+		return std::unique_ptr<MetricsServer>();
+	}
+
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return std::unique_ptr<MetricsServer>();
+	}
+
+	int reuse = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	sockaddr_in address = sockaddr_in();
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, LISTEN_BACKLOG) != 0) {
+		close(fd);
+		return std::unique_ptr<MetricsServer>();
+	}
+
+	return std::unique_ptr<MetricsServer>(new MetricsServer(fd, "", metrics));
+}
+
+MetricsServer::MetricsServer(int listenFd, const std::string &path, const std::shared_ptr<Metrics> &metrics)
+: listenFd(listenFd), path(path), metrics(metrics), stopFlag(false), server(&MetricsServer::serve, this) {
+}
+
+MetricsServer::~MetricsServer() {
+	stopFlag = true;
+	server.join();
+	close(listenFd);
+
+	if (!path.empty()) {
+		unlink(path.c_str());
+	}
+}
+
+void MetricsServer::serve() {
+	while (!stopFlag) {
+		pollfd listenPoll = pollfd();
+		listenPoll.fd = listenFd;
+		listenPoll.events = POLLIN;
+
+		if (poll(&listenPoll, 1, POLL_TIMEOUT_MILLISECONDS) <= 0) {
+			continue;
+		}
+
+		int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+		if (clientFd < 0) {
+			continue;
+		}
+
+		answer(clientFd);
+		close(clientFd);
+	}
+}
+
+void MetricsServer::answer(int clientFd) const {
+	timeval timeout = timeval();
+	timeout.tv_sec = CLIENT_TIMEOUT_SECONDS;
+	setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	// every request gets the metrics, so the request is only read until the end of the header
+	std::string request;
+	char buffer[1024];
+	while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos
+			&& request.size() < sizeof(buffer) * 8) {
+		ssize_t received = recv(clientFd, buffer, sizeof(buffer), 0);
+		if (received < 0 && errno == EINTR) {
+			continue;
+		}
+		if (received <= 0) {
+			return;
+		}
+		request.append(buffer, received);
+	}
+
+	std::string body = metrics->render();
+	std::string response = "HTTP/1.0 200 OK\r\n"
+			"Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+			"Content-Length: " + std::to_string(body.size()) + "\r\n"
+			"Connection: close\r\n\r\n" + body;
+
+	std::size_t sent = 0;
+	while (sent < response.size()) {
+		ssize_t written = send(clientFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			return;
+		}
+		sent += written;
+	}
+}
+
+}
+}
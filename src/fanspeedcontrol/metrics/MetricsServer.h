@@ -0,0 +1,68 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_METRICS_METRICSSERVER_H_
+#define FANSPEEDCONTROL_METRICS_METRICSSERVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "Metrics.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// returns the listening socket or -1, the socket file of a crashed instance is replaced,
+// if ownerOnly, only the user of the process can connect from the creation of the socket file on
+int listenOnUnixSocket(const std::string &path, bool ownerOnly = false);
+
+// serves the metrics over http in its own thread, so that a slow client does not delay the control
+class MetricsServer {
+public:
+	// returns an empty pointer if the socket cannot be created
+	static std::unique_ptr<MetricsServer> createUnixSocketServer(const std::string &path,
+			const std::shared_ptr<Metrics> &metrics);
+	// the port is bound to the loopback address only
+	static std::unique_ptr<MetricsServer> createLoopbackServer(int port, const std::shared_ptr<Metrics> &metrics);
+
+	virtual ~MetricsServer();
+
+	MetricsServer(const MetricsServer &) = delete;
+	MetricsServer &operator=(const MetricsServer &) = delete;
+
+private:
+	MetricsServer(int listenFd, const std::string &path, const std::shared_ptr<Metrics> &metrics);
+
+	const int listenFd;
+	// path of the unix socket, which is removed by the destructor, empty for a port
+	const std::string path;
+	const std::shared_ptr<Metrics> metrics;
+
+	std::atomic<bool> stopFlag;
+	std::thread server;
+
+	void serve();
+	void answer(int clientFd) const;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_METRICS_METRICSSERVER_H_ */
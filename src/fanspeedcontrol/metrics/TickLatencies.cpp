@@ -0,0 +1,79 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "TickLatencies.h"
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "LatencyHistogram.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+TickLatencies::TickLatencies()
+: overruns(0), avoidedWrites(0) {
+}
+
+void TickLatencies::record(const AbstractDevice::PhaseDurations &phases, unsigned long avoidedWrites,
+		const std::chrono::steady_clock::duration &tick, const std::chrono::steady_clock::duration &lateness) {
+	read.record(phases.read);
+	compute.record(phases.compute);
+	// most ticks do not change the fan speed, they would hide the duration of the real writes
+	if (phases.write != std::chrono::steady_clock::duration::zero()) {
+		write.record(phases.write);
+	}
+	this->tick.record(tick);
+	jitter.record(lateness);
+	this->avoidedWrites.store(avoidedWrites, std::memory_order_relaxed);
+}
+
+void TickLatencies::countOverrun() {
+	overruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string TickLatencies::to_string() const {
+	std::stringstream s;
+
+	const auto percentiles = [&s](const std::string &name, const LatencyHistogram &histogram) {
+		const auto microseconds = [](const std::chrono::nanoseconds &duration) {
+			return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+		};
+
+		s << name << " (" << histogram.getCount() << "): p50 " << microseconds(histogram.getPercentile(50))
+				<< ", p90 " << microseconds(histogram.getPercentile(90))
+				<< ", p99 " << microseconds(histogram.getPercentile(99))
+				<< ", p99.9 " << microseconds(histogram.getPercentile(99.9))
+				<< ", max " << microseconds(histogram.getMax()) << "; ";
+	};
+
+	percentiles("read", read);
+	percentiles("compute", compute);
+	percentiles("write", write);
+	percentiles("tick", tick);
+	percentiles("jitter", jitter);
+	s << "overruns: " << overruns.load(std::memory_order_relaxed)
+			<< "; avoided writes: " << avoidedWrites.load(std::memory_order_relaxed);
+
+	return s.str();
+}
+
+}
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_METRICS_TICKLATENCIES_H_
+#define FANSPEEDCONTROL_METRICS_TICKLATENCIES_H_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "LatencyHistogram.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// latencies of the ticks of one device, recorded by the thread which controls the device,
+// every value is an atomic, so that the report can be written by another thread
+class TickLatencies {
+public:
+	TickLatencies();
+
+	// lateness is the time between the deadline of the tick and its start,
+	// avoidedWrites is the number of fan speed and mode writes, which the device has avoided so far
+	void record(const AbstractDevice::PhaseDurations &phases, unsigned long avoidedWrites,
+			const std::chrono::steady_clock::duration &tick, const std::chrono::steady_clock::duration &lateness);
+	void countOverrun();
+
+	// percentiles in microseconds as single line
+	std::string to_string() const;
+
+private:
+	LatencyHistogram read;
+	LatencyHistogram compute;
+	LatencyHistogram write;
+	LatencyHistogram tick;
+	LatencyHistogram jitter;
+	std::atomic<unsigned long> overruns;
+	std::atomic<unsigned long> avoidedWrites;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_METRICS_TICKLATENCIES_H_ */
@@ -18,6 +18,7 @@
 #include "LoggerObserver.h"
 
 #include <chrono>
+#include <mutex>
 #include <iostream>
 #include <memory>
 
@@ -29,23 +30,16 @@
 #include <spdlog/sinks/syslog_sink.h>
 
 #include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "patterns/observer/Event.h"
 #include "patterns/observer/Observable.h"
 #include "SharedStrings.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
 
-LoggerObserver::LoggerObserver(const std::chrono::milliseconds &timeToLogRepeatedError, const std::string &logLevel,
-		const std::string &appName, const std::string &logFile)
-:timeToLogRepeatedError(timeToLogRepeatedError) {
-	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-	lastLoggedTemperatureError = now - timeToLogRepeatedError - std::chrono::milliseconds(1);
-	lastLoggedModeAutomaticSet = now - timeToLogRepeatedError -	std::chrono::milliseconds(1);
-	lastLoggedModeAutomaticSetError = now - timeToLogRepeatedError - std::chrono::milliseconds(1);
-	lastLoggedModeManualSetError = now - timeToLogRepeatedError - std::chrono::milliseconds(1);
-	lastLoggedFanSetError = now - timeToLogRepeatedError - std::chrono::milliseconds(1);
-	lastLoggedTemperatureWarn = now - timeToLogRepeatedError - std::chrono::milliseconds(1);
-
+LoggerObserver::LoggerObserver(const std::chrono::milliseconds &timeToLogRepeatedError, unsigned int burst,
+		const std::string &logLevel, const std::string &appName, const std::string &logFile)
+: rateLimiter(0, AbstractDevice::MESSAGES_COUNT, timeToLogRepeatedError, burst) {
 	try {
 		std::vector<spdlog::sink_ptr> sinks;
 		sinks.push_back(std::make_shared<spdlog::sinks::stdout_sink_mt>());
@@ -82,97 +76,130 @@ LoggerObserver::LoggerObserver(const std::chrono::milliseconds &timeToLogRepeate
 LoggerObserver::~LoggerObserver() {
 }
 
+void LoggerObserver::setSourceCount(std::size_t sources) {
+	std::lock_guard<std::mutex> lock(mutex);
+	rateLimiter.setSourceCount(sources);
+}
+
+void LoggerObserver::logRepeatedError(const msc42::patterns::Event &event, const std::string &message) {
+	unsigned int suppressed;
+	if (!rateLimiter.tryAcquire(event.sourceIndex, event.messageId, event.timestamp, suppressed)) {
+		return;
+	}
+
+	std::string text = (boost::format(DEVICE_MESSAGE_FORMAT) % message % AbstractDevice::to_string(event)).str();
+	if (suppressed > 0) {
+		text = (boost::format(SUPPRESSED_MESSAGE_FORMAT) % text % suppressed).str();
+	}
+
+	logger->error(text);
+	logger->flush();
+}
+
 bool LoggerObserver::notify(int messageId, const std::string &message1, const std::string &message2) {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	if (!logger) {
 		return false;
 	}
 
-	std::chrono::steady_clock::time_point now;
-
 	switch (messageId) {
 
 	case AbstractDevice::CONFIG_FILE_ERROR:
-		logger->error(CONFIG_FILE_ERROR_MESSAGE);
+		logger->error(message1.empty() ? CONFIG_FILE_ERROR_MESSAGE
+				: (boost::format(CONFIG_ERRORS_FORMAT) % CONFIG_FILE_ERROR_MESSAGE % message1).str());
+		logger->flush();
+		break;
+
+	case AbstractDevice::DEVICE_CONFIG:
+		logger->info((boost::format(gettext("Valid configuration of %s")) % message1).str());
+		logger->flush();
+		break;
+
+	case AbstractDevice::LATENCY_REPORT:
+		logger->info((boost::format(gettext("Latencies of %s in microseconds: %s")) % message1 % message2).str());
+		logger->flush();
+		break;
+
+	case AbstractDevice::CONFIG_RELOADED:
+		logger->info((boost::format(gettext("Reloaded the configuration file %s")) % message1).str());
+		logger->flush();
+		break;
+
+	case AbstractDevice::CONFIG_RELOAD_ERROR:
+		logger->error(message1.empty() ? CONFIG_RELOAD_ERROR_MESSAGE
+				: (boost::format(CONFIG_ERRORS_FORMAT) % CONFIG_RELOAD_ERROR_MESSAGE % message1).str());
+		logger->flush();
+		break;
+
+	case AbstractDevice::CONFIG_RELOAD_DEVICES_CHANGED:
+		logger->error(message1.empty() ? CONFIG_RELOAD_DEVICES_CHANGED_MESSAGE
+				: (boost::format(DEVICE_MESSAGE_FORMAT) % CONFIG_RELOAD_DEVICES_CHANGED_MESSAGE % message1).str());
+		logger->flush();
+		break;
+
+	case AbstractDevice::CONTROL_COMMAND:
+		logger->info((boost::format(gettext("Control command for %s: %s")) % message1 % message2).str());
 		logger->flush();
 		break;
 
+	default:
+		break;
+	}
+
+	return true;
+}
+
+bool LoggerObserver::notify(const msc42::patterns::Event &event) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!logger) {
+		return false;
+	}
+
+	switch (event.messageId) {
+
 	case AbstractDevice::TEMPERATUR_READ_ERROR:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLoggedTemperatureError)
-				>= timeToLogRepeatedError) {
-			lastLoggedTemperatureError = now;
-			logger->error(READ_TEMPERATURE_ERROR_MESSAGE);
-			logger->flush();
-		}
+		logRepeatedError(event, READ_TEMPERATURE_ERROR_MESSAGE);
 		break;
 
 	case AbstractDevice::MODE_AUTOMATIC_SET:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLoggedModeAutomaticSet)
-				>= timeToLogRepeatedError) {
-			lastLoggedModeAutomaticSet = now;
-			logger->error(MODE_AUTOMATIC_SET_MESSAGE);
-			logger->flush();
-		}
+		logRepeatedError(event, MODE_AUTOMATIC_SET_MESSAGE);
 		break;
 
 	case AbstractDevice::MODE_AUTOMATIC_SET_ERROR:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLoggedModeAutomaticSetError)
-				>= timeToLogRepeatedError) {
-			lastLoggedModeAutomaticSetError = now;
-			logger->error(MODE_AUTOMATIC_ERROR_MESSAGE);
-			logger->flush();
-		}
+		logRepeatedError(event, MODE_AUTOMATIC_ERROR_MESSAGE);
 		break;
 
 	case AbstractDevice::MODE_MANUAL_SET_ERROR:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLoggedModeManualSetError)
-				>= timeToLogRepeatedError) {
-			lastLoggedModeManualSetError = now;
-			logger->error(MODE_MANUAL_ERROR_MESSAGE);
-			logger->flush();
-		}
+		logRepeatedError(event, MODE_MANUAL_ERROR_MESSAGE);
 		break;
 
 	case AbstractDevice::FAN_SET:
-		logger->debug((boost::format(gettext("Fan of %s is set to %s.")) % message1 % message2).str());
-		logger->flush();
-		break;
-
-	case AbstractDevice::FAN_SET_ERROR:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLoggedFanSetError)
-				>= timeToLogRepeatedError) {
-			lastLoggedFanSetError = now;
-			logger->error(FAN_SET_ERROR_MESSAGE);
+		// the message is only formatted if it is logged
+		if (logger->should_log(spdlog::level::debug)) {
+			logger->debug((boost::format(gettext("Fan of %s is set to %s.")) % AbstractDevice::to_string(event)
+					% event.fanSpeed).str());
 			logger->flush();
 		}
 		break;
 
-	case AbstractDevice::DEVICE_CONFIG:
-		logger->info((boost::format(gettext("Valid configuration of %s")) % message1).str());
-		logger->flush();
+	case AbstractDevice::FAN_SET_ERROR:
+		logRepeatedError(event, FAN_SET_ERROR_MESSAGE);
 		break;
 
 	case AbstractDevice::TEMPERATURE_WARN:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLoggedTemperatureWarn)
-				>= timeToLogRepeatedError) {
-			lastLoggedTemperatureWarn = now;
-			logger->error(TEMPERATURE_TOO_HIGH);
-			logger->flush();
-		}
+		logRepeatedError(event, TEMPERATURE_TOO_HIGH);
 		break;
 
 	case AbstractDevice::DEVICE_TERMINATED:
-		logger->info((boost::format(gettext("Device %s is terminated.")) % message1).str());
+		logger->info((boost::format(gettext("Device %s is terminated.")) % AbstractDevice::to_string(event)).str());
 		logger->flush();
 		break;
 
 	case AbstractDevice::DEVICE_TERMINATED_ERROR:
-		logger->error((boost::format(gettext("Device %s is terminated with errors.")) % message1).str());
+		logger->error((boost::format(gettext("Device %s is terminated with errors."))
+				% AbstractDevice::to_string(event)).str());
 		logger->flush();
 		break;
 
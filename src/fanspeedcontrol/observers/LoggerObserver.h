@@ -19,11 +19,16 @@
 #define FANSPEEDCONTROL_OBSERVERS_LOGGEROBSERVER_H_
 
 #include <chrono>
+#include <cstddef>
+#include <mutex>
 #include <memory>
+#include <string>
 
 #include <spdlog/spdlog.h>
 
 #include "patterns/observer/AbstractObserver.h"
+#include "patterns/observer/Event.h"
+#include "patterns/ratelimit/RateLimiter.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
@@ -32,21 +37,24 @@ class Observable;
 
 class LoggerObserver: public msc42::patterns::AbstractObserver {
 public:
-	LoggerObserver(const std::chrono::milliseconds &timeToLogRepeatedError, const std::string &logLevel,
-			const std::string &appName, const std::string &logFile);
+	LoggerObserver(const std::chrono::milliseconds &timeToLogRepeatedError, unsigned int burst,
+			const std::string &logLevel, const std::string &appName, const std::string &logFile);
 	virtual ~LoggerObserver();
 	bool notify(int messageId, const std::string &message1 = "", const std::string &message2 = "");
+	bool notify(const msc42::patterns::Event &event);
+	// sizes the rate limiting table, must be called with the number of devices before events are sent
+	void setSourceCount(std::size_t sources);
 
 private:
+	// the observer is shared by all devices, which can be controlled by different threads
+	std::mutex mutex;
+
 	std::shared_ptr<spdlog::logger> logger;
 
-	const std::chrono::milliseconds timeToLogRepeatedError;
-	std::chrono::steady_clock::time_point lastLoggedTemperatureError;
-	std::chrono::steady_clock::time_point lastLoggedModeAutomaticSet;
-	std::chrono::steady_clock::time_point lastLoggedModeAutomaticSetError;
-	std::chrono::steady_clock::time_point lastLoggedModeManualSetError;
-	std::chrono::steady_clock::time_point lastLoggedFanSetError;
-	std::chrono::steady_clock::time_point lastLoggedTemperatureWarn;
+	// repeated errors are limited per device and message
+	msc42::patterns::RateLimiter rateLimiter;
+
+	void logRepeatedError(const msc42::patterns::Event &event, const std::string &message);
 };
 
 }
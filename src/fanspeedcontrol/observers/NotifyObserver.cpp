@@ -18,6 +18,8 @@
 #include "NotifyObserver.h"
 
 #include <chrono>
+#include <cstddef>
+#include <mutex>
 #include <string>
 
 #include <boost/format.hpp>
@@ -25,22 +27,15 @@
 
 #include "fanspeedcontrol/config/ArgsAndConfigProcessor.h"
 #include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "patterns/observer/Event.h"
 #include "SharedStrings.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
 
-NotifyObserver::NotifyObserver(const std::chrono::milliseconds &timeToNotifyRepeatedError, const std::string &appName)
-: timeToNotifyRepeatedError(timeToNotifyRepeatedError) {
-	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-
-	lastNotifiedTemperatureError = now - timeToNotifyRepeatedError - std::chrono::milliseconds(1);
-	lastNotifiedModeAutomaticSet = now - timeToNotifyRepeatedError - std::chrono::milliseconds(1);
-	lastNotifiedModeAutomaticSetError = now - timeToNotifyRepeatedError - std::chrono::milliseconds(1);
-	lastNotifiedModeManualSetError = now - timeToNotifyRepeatedError - std::chrono::milliseconds(1);
-	lastNotifiedFanSetError = now - timeToNotifyRepeatedError - std::chrono::milliseconds(1);
-	lastNotifiedTemperaturWarn = now - timeToNotifyRepeatedError - std::chrono::milliseconds(1);
-
+NotifyObserver::NotifyObserver(const std::chrono::milliseconds &timeToNotifyRepeatedError, unsigned int burst,
+		const std::string &appName)
+: rateLimiter(0, AbstractDevice::MESSAGES_COUNT, timeToNotifyRepeatedError, burst) {
 	notify_init(appName.c_str());
 }
 
@@ -55,67 +50,66 @@ void newMessage(const std::string &message) {
 	notify_notification_show(n, 0);
 }
 
-bool NotifyObserver::notify(int messageId, const std::string &message1, const std::string &message2) {
-	std::chrono::steady_clock::time_point now;
+void NotifyObserver::setSourceCount(std::size_t sources) {
+	std::lock_guard<std::mutex> lock(mutex);
+	rateLimiter.setSourceCount(sources);
+}
+
+void NotifyObserver::notifyRepeatedError(const msc42::patterns::Event &event, const std::string &message) {
+	unsigned int suppressed;
+	if (!rateLimiter.tryAcquire(event.sourceIndex, event.messageId, event.timestamp, suppressed)) {
+		return;
+	}
+
+	std::string text = (boost::format(DEVICE_MESSAGE_FORMAT) % message % AbstractDevice::to_string(event)).str();
+	if (suppressed > 0) {
+		text = (boost::format(SUPPRESSED_MESSAGE_FORMAT) % text % suppressed).str();
+	}
+
+	newMessage(text);
+}
 
-	switch (messageId) {
+bool NotifyObserver::notify(int messageId, const std::string &message1, const std::string &message2) {
+	std::lock_guard<std::mutex> lock(mutex);
 
-	case AbstractDevice::CONFIG_FILE_ERROR:
+	if (messageId == AbstractDevice::CONFIG_FILE_ERROR) {
 		newMessage(CONFIG_FILE_ERROR_MESSAGE);
-		break;
+	} else if (messageId == AbstractDevice::CONFIG_RELOAD_ERROR) {
+		newMessage(CONFIG_RELOAD_ERROR_MESSAGE);
+	} else if (messageId == AbstractDevice::CONFIG_RELOAD_DEVICES_CHANGED) {
+		newMessage(CONFIG_RELOAD_DEVICES_CHANGED_MESSAGE);
+	}
+
+	return true;
+}
+
+bool NotifyObserver::notify(const msc42::patterns::Event &event) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	switch (event.messageId) {
 
 	case AbstractDevice::TEMPERATUR_READ_ERROR:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastNotifiedTemperatureError)
-				>= timeToNotifyRepeatedError) {
-			lastNotifiedTemperatureError = now;
-			newMessage(READ_TEMPERATURE_ERROR_MESSAGE);
-		}
+		notifyRepeatedError(event, READ_TEMPERATURE_ERROR_MESSAGE);
 		break;
 
 	case AbstractDevice::MODE_AUTOMATIC_SET:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastNotifiedModeAutomaticSet)
-				>= timeToNotifyRepeatedError) {
-			lastNotifiedModeAutomaticSet = now;
-			newMessage(MODE_AUTOMATIC_SET_MESSAGE);
-		}
+		notifyRepeatedError(event, MODE_AUTOMATIC_SET_MESSAGE);
 		break;
 
 	case AbstractDevice::MODE_AUTOMATIC_SET_ERROR:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastNotifiedModeAutomaticSet)
-				>= timeToNotifyRepeatedError) {
-			lastNotifiedModeAutomaticSet = now;
-			newMessage(MODE_AUTOMATIC_ERROR_MESSAGE);
-		}
+		notifyRepeatedError(event, MODE_AUTOMATIC_ERROR_MESSAGE);
 		break;
 
 	case AbstractDevice::MODE_MANUAL_SET_ERROR:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastNotifiedModeManualSetError)
-				>= timeToNotifyRepeatedError) {
-			lastNotifiedModeManualSetError = now;
-			newMessage((MODE_MANUAL_ERROR_MESSAGE));
-		}
+		notifyRepeatedError(event, MODE_MANUAL_ERROR_MESSAGE);
 		break;
 
 	case AbstractDevice::FAN_SET_ERROR:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastNotifiedFanSetError)
-				>= timeToNotifyRepeatedError) {
-			lastNotifiedFanSetError = now;
-			newMessage(FAN_SET_ERROR_MESSAGE);
-		}
+		notifyRepeatedError(event, FAN_SET_ERROR_MESSAGE);
 		break;
 
 	case AbstractDevice::TEMPERATURE_WARN:
-		now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastNotifiedTemperaturWarn)
-				>= timeToNotifyRepeatedError) {
-			lastNotifiedTemperaturWarn = now;
-			newMessage(TEMPERATURE_TOO_HIGH);
-		}
+		notifyRepeatedError(event, TEMPERATURE_TOO_HIGH);
 		break;
 
 	default:
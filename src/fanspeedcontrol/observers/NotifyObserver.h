@@ -19,27 +19,35 @@
 #define FANSPEEDCONTROL_OBSERVERS_NOTIFYOBSERVER_H_
 
 #include <chrono>
+#include <cstddef>
+#include <mutex>
 #include <string>
 
 #include "patterns/observer/AbstractObserver.h"
+#include "patterns/observer/Event.h"
+#include "patterns/ratelimit/RateLimiter.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
 
 class NotifyObserver: public msc42::patterns::AbstractObserver {
 public:
-	NotifyObserver(const std::chrono::milliseconds &timeToNotifyRepeatedError, const std::string &appName);
+	NotifyObserver(const std::chrono::milliseconds &timeToNotifyRepeatedError, unsigned int burst,
+			const std::string &appName);
 	virtual ~NotifyObserver();
 	virtual bool notify(int messageId, const std::string &message1 = "", const std::string &message2 = "");
+	virtual bool notify(const msc42::patterns::Event &event);
+	// sizes the rate limiting table, must be called with the number of devices before events are sent
+	void setSourceCount(std::size_t sources);
 
 private:
-	const std::chrono::milliseconds timeToNotifyRepeatedError;
-	std::chrono::steady_clock::time_point lastNotifiedTemperatureError;
-	std::chrono::steady_clock::time_point lastNotifiedModeAutomaticSet;
-	std::chrono::steady_clock::time_point lastNotifiedModeAutomaticSetError;
-	std::chrono::steady_clock::time_point lastNotifiedModeManualSetError;
-	std::chrono::steady_clock::time_point lastNotifiedFanSetError;
-	std::chrono::steady_clock::time_point lastNotifiedTemperaturWarn;
+	// the observer is shared by all devices, which can be controlled by different threads
+	std::mutex mutex;
+
+	// repeated errors are limited per device and message
+	msc42::patterns::RateLimiter rateLimiter;
+
+	void notifyRepeatedError(const msc42::patterns::Event &event, const std::string &message);
 };
 
 }
@@ -26,6 +26,11 @@ namespace msc42 {
 namespace fanspeedcontrol {
 
 	const std::string CONFIG_FILE_ERROR_MESSAGE = gettext("The configuration file is not valid.");
+	const std::string CONFIG_RELOAD_ERROR_MESSAGE = gettext(
+			"The reloaded configuration file is not valid, the running configuration is kept.");
+	const std::string CONFIG_RELOAD_DEVICES_CHANGED_MESSAGE = gettext(
+			"The devices of the reloaded configuration file differ from the running devices, "
+			"restart to apply it, the running configuration is kept.");
 	const std::string READ_TEMPERATURE_ERROR_MESSAGE = gettext("Cannot read the temperature of at least one device.");
 	const std::string MODE_AUTOMATIC_SET_MESSAGE = gettext("Set at least one device to automatic mode.");
 	const std::string MODE_AUTOMATIC_ERROR_MESSAGE = gettext("Cannot set at least one device to automatic mode.");
@@ -33,6 +38,13 @@ namespace fanspeedcontrol {
 	const std::string FAN_SET_ERROR_MESSAGE = gettext("Cannot set fan speed of at least one device.");
 	const std::string TEMPERATURE_TOO_HIGH = gettext("Temperature of at least one device is very high.");
 
+	// arguments: message, device
+	const std::string DEVICE_MESSAGE_FORMAT = gettext("%s Device: %s");
+	// arguments: message, errors of the configuration file
+	const std::string CONFIG_ERRORS_FORMAT = gettext("%s Errors: %s");
+	// arguments: message, number of suppressed repetitions
+	const std::string SUPPRESSED_MESSAGE_FORMAT = gettext("%s (%d repetitions were suppressed)");
+
 }
 }
 
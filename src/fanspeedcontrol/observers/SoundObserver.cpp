@@ -18,10 +18,12 @@
 #include "SoundObserver.h"
 
 #include <chrono>
+#include <mutex>
 #include <cstdlib>
 #include <string>
 
 #include "fanspeedcontrol/devices/AbstractDevice.h"
+#include "patterns/observer/Event.h"
 
 namespace msc42 {
 namespace fanspeedcontrol {
@@ -30,28 +32,33 @@ const std::chrono::milliseconds timeToRepeatBeep(1000);
 
 SoundObserver::SoundObserver(bool beep, const std::string soundFile,
 		const std::chrono::milliseconds &timeToStartSoundAgain)
-: beep(beep), soundFile(soundFile), timeToStartSoundAgain(timeToStartSoundAgain) {
+: beep(beep), soundFile(soundFile),
+  beepRateLimiter(1, AbstractDevice::MESSAGES_COUNT, timeToRepeatBeep),
+  soundRateLimiter(1, AbstractDevice::MESSAGES_COUNT, timeToStartSoundAgain) {
 	playSoundCommand = "ffplay -loglevel panic -nodisp " + soundFile + " &";
-	lastTimeBeepStarted = std::chrono::steady_clock::now() - timeToRepeatBeep - std::chrono::milliseconds(1);
 }
 
 SoundObserver::~SoundObserver() {
 }
 
 bool SoundObserver::notify(int messageId, const std::string &message1, const std::string &message2) {
-	if (messageId == AbstractDevice::MODE_AUTOMATIC_SET_ERROR) {
-		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	return true;
+}
+
+bool SoundObserver::notify(const msc42::patterns::Event &event) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (event.messageId == AbstractDevice::MODE_AUTOMATIC_SET_ERROR) {
+		// the sound has no text, so the number of suppressed alarms is not reported
+		unsigned int suppressed;
 
-		if (beep && std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTimeBeepStarted)
-				>= timeToRepeatBeep) {
+		if (beep && beepRateLimiter.tryAcquire(0, event.messageId, event.timestamp, suppressed)) {
 			std::system("beep");
-			lastTimeBeepStarted = now;
 		}
 
-		if (!soundFile.empty() && std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTimeSoundStarted)
-				>= timeToStartSoundAgain) {
+		if (!soundFile.empty()
+				&& soundRateLimiter.tryAcquire(0, event.messageId, event.timestamp, suppressed)) {
 			std::system(playSoundCommand.c_str());
-			lastTimeSoundStarted = now;
 		}
 	}
 
@@ -19,9 +19,12 @@
 #define FANSPEEDCONTROL_OBSERVERS_SOUNDOBSERVER_H_
 
 #include <chrono>
+#include <mutex>
 #include <string>
 
 #include <patterns/observer/AbstractObserver.h>
+#include <patterns/observer/Event.h>
+#include <patterns/ratelimit/RateLimiter.h>
 
 namespace msc42 {
 namespace fanspeedcontrol {
@@ -31,14 +34,18 @@ public:
 	SoundObserver(bool beep, const std::string soundFile = "", const std::chrono::milliseconds &timeToStartSoundAgain = std::chrono::milliseconds(0));
 	virtual ~SoundObserver();
 	virtual bool notify(int messageId, const std::string &message1 = "", const std::string &message2 = "");
+	virtual bool notify(const msc42::patterns::Event &event);
 
 private:
+	// the observer is shared by all devices, which can be controlled by different threads
+	std::mutex mutex;
+
 	const bool beep;
 	const std::string soundFile;
 	std::string playSoundCommand;
-	const std::chrono::milliseconds timeToStartSoundAgain;
-	std::chrono::steady_clock::time_point lastTimeBeepStarted;
-	std::chrono::steady_clock::time_point lastTimeSoundStarted;
+	// a single sound alarms for all devices, so the alarms are limited per message id and not per device
+	msc42::patterns::RateLimiter beepRateLimiter;
+	msc42::patterns::RateLimiter soundRateLimiter;
 };
 
 }
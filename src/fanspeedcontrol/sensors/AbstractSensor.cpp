@@ -0,0 +1,41 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "AbstractSensor.h"
+
+#include <string>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+AbstractSensor::AbstractSensor(const std::string &name)
+: name(name) {
+}
+
+AbstractSensor::~AbstractSensor() {
+}
+
+bool AbstractSensor::checkIfValid() const {
+	return true;
+}
+
+const std::string &AbstractSensor::getName() const {
+	return name;
+}
+
+}
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_SENSORS_ABSTRACTSENSOR_H_
+#define FANSPEEDCONTROL_SENSORS_ABSTRACTSENSOR_H_
+
+#include <string>
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// temperature sensor without a fan, which can be shared by several fans
+class AbstractSensor {
+public:
+	AbstractSensor(const std::string &name);
+	virtual ~AbstractSensor();
+
+	// returns the temperature in celsius or a temperature below the absolute zero if it cannot be read
+	virtual int readTemperature() = 0;
+	virtual bool checkIfValid() const;
+	const std::string &getName() const;
+
+protected:
+	const std::string name;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_SENSORS_ABSTRACTSENSOR_H_ */
@@ -0,0 +1,44 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_SENSORS_HWMONSENSOR_H_
+#define FANSPEEDCONTROL_SENSORS_HWMONSENSOR_H_
+
+#include <string>
+
+#include "AbstractSensor.h"
+#include "fanspeedcontrol/devices/SysfsFile.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+class HwmonSensor: public AbstractSensor {
+public:
+	HwmonSensor(const std::string &name, const std::string &sysfsRoot, const std::string &temperatureInput);
+	virtual ~HwmonSensor();
+
+	virtual int readTemperature();
+	virtual bool checkIfValid() const;
+
+protected:
+	const SysfsFile temperatureFile;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_SENSORS_HWMONSENSOR_H_ */
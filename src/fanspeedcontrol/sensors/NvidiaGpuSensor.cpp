@@ -0,0 +1,45 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "NvidiaGpuSensor.h"
+
+#include <memory>
+#include <string>
+
+#include "fanspeedcontrol/devices/NvidiaGpu.h"
+#include "fanspeedcontrol/devices/XDisplayConnection.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+NvidiaGpuSensor::NvidiaGpuSensor(const std::string &name, int id, const std::string &displayName)
+: AbstractSensor(name), id(id), connection(XDisplayConnection::getConnection(displayName)) {
+}
+
+NvidiaGpuSensor::~NvidiaGpuSensor() {
+}
+
+int NvidiaGpuSensor::readTemperature() {
+	return NvidiaGpu::readTemperature(*connection, id);
+}
+
+bool NvidiaGpuSensor::checkIfValid() const {
+	return NvidiaGpu::readTemperature(*connection, id) > -274;
+}
+
+}
+}
@@ -0,0 +1,47 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_SENSORS_NVIDIAGPUSENSOR_H_
+#define FANSPEEDCONTROL_SENSORS_NVIDIAGPUSENSOR_H_
+
+#include <memory>
+#include <string>
+
+#include "AbstractSensor.h"
+#include "fanspeedcontrol/devices/XDisplayConnection.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+class NvidiaGpuSensor: public AbstractSensor {
+public:
+	NvidiaGpuSensor(const std::string &name, int id, const std::string &displayName);
+	virtual ~NvidiaGpuSensor();
+
+	virtual int readTemperature();
+	// the display can be opened and the gpu answers the query of the temperature
+	virtual bool checkIfValid() const;
+
+protected:
+	const int id;
+	std::shared_ptr<XDisplayConnection> connection;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_SENSORS_NVIDIAGPUSENSOR_H_ */
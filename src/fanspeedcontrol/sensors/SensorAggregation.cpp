@@ -0,0 +1,167 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SensorAggregation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <libintl.h>
+
+#include "SensorSnapshot.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+const int INVALID_TEMPERATURE = -274;
+
+SensorAggregation::SensorAggregation(const std::shared_ptr<SensorSnapshot> &snapshot,
+		const std::vector<std::size_t> &sensors, Type type, const std::vector<double> &weights, double alpha)
+: snapshot(snapshot), sensors(sensors), type(type), weights(weights), alpha(alpha) {
+}
+
+SensorAggregation::~SensorAggregation() {
+}
+
+int SensorAggregation::getTemperature(Average &average) const {
+	double maxTemperature = INVALID_TEMPERATURE;
+	double sum = 0;
+	double weightedSum = 0;
+	double weightSum = 0;
+
+	for (std::size_t i = 0; i < sensors.size(); ++i) {
+		int temperature = snapshot->getTemperature(sensors[i]);
+
+		// the fan must fall back to the automatic mode if one sensor fails, even if the other sensors are cool
+		if (temperature <= INVALID_TEMPERATURE) {
+			average.isInitialized = false;
+			return INVALID_TEMPERATURE;
+		}
+
+		maxTemperature = std::max<double>(maxTemperature, temperature);
+		sum += temperature;
+		if (type == AGGREGATION_WEIGHTED) {
+			weightedSum += weights[i] * temperature;
+			weightSum += weights[i];
+		}
+	}
+
+	switch (type) {
+	case AGGREGATION_MEAN:
+		return static_cast<int>(std::lround(sum / sensors.size()));
+
+	case AGGREGATION_WEIGHTED:
+		return static_cast<int>(std::lround(weightedSum / weightSum));
+
+	case AGGREGATION_EWMA:
+		// smoothed over the time, the maximum of the sensors is used to not hide a single hot sensor
+		if (average.isInitialized) {
+			average.value = alpha * maxTemperature + (1 - alpha) * average.value;
+		} else {
+			average.value = maxTemperature;
+			average.isInitialized = true;
+		}
+		return static_cast<int>(std::lround(average.value));
+
+	default:
+		return static_cast<int>(maxTemperature);
+	}
+}
+
+void SensorAggregation::checkAttributes(InvalidAttributes &invalidAttributes) const {
+	if (sensors.empty()) {
+		invalidAttributes.push_back({"sensors", gettext("must contain at least one sensor")});
+	}
+
+	// the sensors are checked once when they are opened, the parameters are also checked while the fan is controlled
+	for (std::size_t sensor : sensors) {
+		if (sensor >= snapshot->size()) {
+			invalidAttributes.push_back({"sensors", gettext("contains a sensor, which cannot be read")});
+			break;
+		}
+	}
+
+	if (type == AGGREGATION_WEIGHTED) {
+		double weightSum = 0;
+		bool isNegative = false;
+		for (double weight : weights) {
+			isNegative = isNegative || weight < 0;
+			weightSum += weight;
+		}
+
+		if (weights.size() != sensors.size() || isNegative || weightSum <= 0) {
+			invalidAttributes.push_back({"weights",
+					gettext("must contain a weight for every sensor, which is not negative, with a positive sum")});
+		}
+	}
+
+	if (type == AGGREGATION_EWMA && (alpha <= 0 || alpha > 1)) {
+		invalidAttributes.push_back({"alpha", gettext("must be greater than 0 and at most 1")});
+	}
+}
+
+std::string SensorAggregation::to_string() const {
+	std::stringstream s;
+
+	s << "{\"aggregation\":";
+	switch (type) {
+	case AGGREGATION_MEAN:
+		s << "\"mean\"";
+		break;
+	case AGGREGATION_WEIGHTED:
+		s << "\"weighted\"";
+		break;
+	case AGGREGATION_EWMA:
+		s << "\"ewma\", \"alpha\":" << alpha;
+		break;
+	default:
+		s << "\"max\"";
+		break;
+	}
+
+	s << ", \"sensors\":[";
+	for (std::size_t i = 0; i < sensors.size(); ++i) {
+		if (i > 0) {
+			s << ", ";
+		}
+		s << "\"" << snapshot->getSensor(sensors[i]).getName() << "\"";
+	}
+	s << "]";
+
+	if (type == AGGREGATION_WEIGHTED) {
+		s << ", \"weights\":[";
+		for (std::size_t i = 0; i < weights.size(); ++i) {
+			if (i > 0) {
+				s << ", ";
+			}
+			s << weights[i];
+		}
+		s << "]";
+	}
+
+	s << "}";
+
+	return s.str();
+}
+
+}
+}
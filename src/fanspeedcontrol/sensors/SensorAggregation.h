@@ -0,0 +1,71 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_SENSORS_SENSORAGGREGATION_H_
+#define FANSPEEDCONTROL_SENSORS_SENSORAGGREGATION_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SensorSnapshot.h"
+#include "fanspeedcontrol/devices/InvalidAttribute.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// temperature of a fan aggregated from one or more sensors of a snapshot, the aggregation is immutable,
+// so that it can be shared by the copies of the parameters of the fan
+class SensorAggregation {
+public:
+	enum Type {
+		AGGREGATION_MAX,
+		AGGREGATION_MEAN,
+		AGGREGATION_WEIGHTED,
+		AGGREGATION_EWMA
+	};
+
+	// state of the aggregation ewma, which is kept by the fan
+	struct Average {
+		double value = 0;
+		bool isInitialized = false;
+	};
+
+	SensorAggregation(const std::shared_ptr<SensorSnapshot> &snapshot, const std::vector<std::size_t> &sensors,
+			Type type, const std::vector<double> &weights = std::vector<double>(), double alpha = 1);
+	virtual ~SensorAggregation();
+
+	// returns the aggregated temperature or a temperature below the absolute zero if one sensor cannot be read,
+	// the average is only used and updated by the aggregation ewma
+	int getTemperature(Average &average) const;
+	// adds every parameter, which is not valid, with the attribute of the configuration file
+	void checkAttributes(InvalidAttributes &invalidAttributes) const;
+	std::string to_string() const;
+
+private:
+	const std::shared_ptr<SensorSnapshot> snapshot;
+	const std::vector<std::size_t> sensors;
+	const Type type;
+	const std::vector<double> weights;
+	const double alpha;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_SENSORS_SENSORAGGREGATION_H_ */
@@ -0,0 +1,90 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SensorSnapshot.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AbstractSensor.h"
+#include "patterns/clock/Clock.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+SensorSnapshot::SensorSnapshot(const std::chrono::milliseconds &maxAge,
+		const std::shared_ptr<msc42::patterns::Clock> &clock)
+: maxAge(maxAge), clock(clock) {
+}
+
+SensorSnapshot::~SensorSnapshot() {
+}
+
+std::size_t SensorSnapshot::addSensor(std::unique_ptr<AbstractSensor> sensor) {
+	std::unique_ptr<entry> newEntry(new entry());
+	newEntry->sensor = std::move(sensor);
+	entries.push_back(std::move(newEntry));
+	return entries.size() - 1;
+}
+
+bool SensorSnapshot::findSensor(const std::string &name, std::size_t &index) const {
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		if (entries[i]->sensor->getName() == name) {
+			index = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const AbstractSensor &SensorSnapshot::getSensor(std::size_t index) const {
+	return *entries[index]->sensor;
+}
+
+std::size_t SensorSnapshot::size() const {
+	return entries.size();
+}
+
+void SensorSnapshot::setMaxAge(const std::chrono::milliseconds &maxAge) {
+	this->maxAge.store(maxAge, std::memory_order_relaxed);
+}
+
+int SensorSnapshot::getTemperature(std::size_t index) {
+	entry &sensorEntry = *entries[index];
+
+	// a second fan waits for the reading of the first fan instead of reading the sensor again
+	std::lock_guard<std::mutex> lock(sensorEntry.mutex);
+
+	std::chrono::steady_clock::time_point now = clock->now();
+	if (!sensorEntry.isRead || now - sensorEntry.readTime >= maxAge.load(std::memory_order_relaxed)) {
+		sensorEntry.temperature = sensorEntry.sensor->readTemperature();
+		sensorEntry.readTime = now;
+		sensorEntry.isRead = true;
+	}
+
+	return sensorEntry.temperature;
+}
+
+}
+}
@@ -0,0 +1,68 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FANSPEEDCONTROL_SENSORS_SENSORSNAPSHOT_H_
+#define FANSPEEDCONTROL_SENSORS_SENSORSNAPSHOT_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "AbstractSensor.h"
+#include "patterns/clock/Clock.h"
+
+namespace msc42 {
+namespace fanspeedcontrol {
+
+// last temperatures of all sensors, a sensor is read again only if its temperature is older than maxAge,
+// so all fans which use a sensor in the same tick share one reading
+class SensorSnapshot {
+public:
+	SensorSnapshot(const std::chrono::milliseconds &maxAge, const std::shared_ptr<msc42::patterns::Clock> &clock);
+	virtual ~SensorSnapshot();
+
+	std::size_t addSensor(std::unique_ptr<AbstractSensor> sensor);
+	bool findSensor(const std::string &name, std::size_t &index) const;
+	const AbstractSensor &getSensor(std::size_t index) const;
+	std::size_t size() const;
+	// can be called from any thread, e.g. for a reloaded configuration
+	void setMaxAge(const std::chrono::milliseconds &maxAge);
+
+	int getTemperature(std::size_t index);
+
+private:
+	struct entry {
+		std::unique_ptr<AbstractSensor> sensor;
+		std::mutex mutex;
+		int temperature = -274;
+		bool isRead = false;
+		std::chrono::steady_clock::time_point readTime;
+	};
+
+	std::atomic<std::chrono::milliseconds> maxAge;
+	const std::shared_ptr<msc42::patterns::Clock> clock;
+	std::vector<std::unique_ptr<entry>> entries;
+};
+
+}
+}
+
+#endif /* FANSPEEDCONTROL_SENSORS_SENSORSNAPSHOT_H_ */
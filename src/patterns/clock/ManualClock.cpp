@@ -0,0 +1,49 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "ManualClock.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace msc42 {
+namespace patterns {
+
+ManualClock::ManualClock(const std::chrono::steady_clock::time_point &start)
+: ticks(start.time_since_epoch().count()) {
+}
+
+ManualClock::~ManualClock() {
+}
+
+std::chrono::steady_clock::time_point ManualClock::now() const {
+	return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(
+			ticks.load(std::memory_order_relaxed)));
+}
+
+void ManualClock::sleepFor(const std::chrono::steady_clock::duration &duration) {
+	advance(duration);
+}
+
+void ManualClock::advance(const std::chrono::steady_clock::duration &duration) {
+	if (duration.count() > 0) {
+		ticks.fetch_add(duration.count(), std::memory_order_relaxed);
+	}
+}
+
+}
+}
@@ -0,0 +1,46 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MANUALCLOCK_H_
+#define MANUALCLOCK_H_
+
+#include <atomic>
+#include <chrono>
+
+#include "Clock.h"
+
+namespace msc42 {
+namespace patterns {
+
+// time which only advances by sleeping or advance, so a single threaded loop runs deterministic
+// and as fast as possible, with several threads every sleeping thread advances the time of all threads
+class ManualClock : public Clock {
+public:
+	ManualClock(const std::chrono::steady_clock::time_point &start = std::chrono::steady_clock::time_point());
+	virtual ~ManualClock();
+	virtual std::chrono::steady_clock::time_point now() const;
+	virtual void sleepFor(const std::chrono::steady_clock::duration &duration);
+	void advance(const std::chrono::steady_clock::duration &duration);
+
+private:
+	std::atomic<std::chrono::steady_clock::rep> ticks;
+};
+
+}
+}
+
+#endif /* MANUALCLOCK_H_ */
@@ -0,0 +1,44 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SCALEDCLOCK_H_
+#define SCALEDCLOCK_H_
+
+#include <chrono>
+
+#include "Clock.h"
+
+namespace msc42 {
+namespace patterns {
+
+// time which runs factor times faster than the real time, it can be used by several threads
+class ScaledClock : public Clock {
+public:
+	ScaledClock(double factor);
+	virtual ~ScaledClock();
+	virtual std::chrono::steady_clock::time_point now() const;
+	virtual void sleepFor(const std::chrono::steady_clock::duration &duration);
+
+private:
+	const double factor;
+	const std::chrono::steady_clock::time_point start;
+};
+
+}
+}
+
+#endif /* SCALEDCLOCK_H_ */
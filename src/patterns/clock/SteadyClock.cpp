@@ -0,0 +1,41 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SteadyClock.h"
+
+#include <chrono>
+#include <thread>
+
+namespace msc42 {
+namespace patterns {
+
+SteadyClock::SteadyClock() {
+}
+
+SteadyClock::~SteadyClock() {
+}
+
+std::chrono::steady_clock::time_point SteadyClock::now() const {
+	return std::chrono::steady_clock::now();
+}
+
+void SteadyClock::sleepFor(const std::chrono::steady_clock::duration &duration) {
+	std::this_thread::sleep_for(duration);
+}
+
+}
+}
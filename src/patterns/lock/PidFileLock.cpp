@@ -0,0 +1,107 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "PidFileLock.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace msc42 {
+namespace patterns {
+
+// the owner could remove the file between the open and the flock of another process,
+// then the other process locks a removed file and tries again
+const int MAX_LOCK_ATTEMPTS = 8;
+
+pid_t readPid(int fd) {
+	char buffer[32];
+	ssize_t length = pread(fd, buffer, sizeof(buffer) - 1, 0);
+	if (length <= 0) {
+		return 0;
+	}
+	buffer[length] = '\0';
+
+	long pid = std::strtol(buffer, nullptr, 10);
+	return pid > 0 ? static_cast<pid_t>(pid) : 0;
+}
+
+bool isSameFile(int fd, const std::string &path) {
+	struct stat opened;
+	struct stat linked;
+	return fstat(fd, &opened) == 0 && stat(path.c_str(), &linked) == 0
+			&& opened.st_dev == linked.st_dev && opened.st_ino == linked.st_ino;
+}
+
+std::unique_ptr<PidFileLock> PidFileLock::tryLock(const std::string &path, pid_t &ownerPid) {
+	ownerPid = 0;
+
+	for (int attempt = 0; attempt < MAX_LOCK_ATTEMPTS; ++attempt) {
+		int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+		if (fd < 0) {
+			return std::unique_ptr<PidFileLock>();
+		}
+
+		if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+			ownerPid = errno == EWOULDBLOCK ? readPid(fd) : 0;
+			close(fd);
+			return std::unique_ptr<PidFileLock>();
+		}
+
+		if (!isSameFile(fd, path)) {
+			close(fd);
+			continue;
+		}
+
+		// a process id in an unlocked file is left by an owner, which could not remove the file
+		ownerPid = readPid(fd);
+
+		std::string pid = std::to_string(getpid()) + "\n";
+		if (ftruncate(fd, 0) != 0 || pwrite(fd, pid.data(), pid.size(), 0) != static_cast<ssize_t>(pid.size())) {
+			close(fd);
+			return std::unique_ptr<PidFileLock>();
+		}
+
+		return std::unique_ptr<PidFileLock>(new PidFileLock(fd, path));
+	}
+
+	return std::unique_ptr<PidFileLock>();
+}
+
+PidFileLock::PidFileLock(int fd, const std::string &path)
+: fd(fd), path(path) {
+}
+
+PidFileLock::~PidFileLock() {
+	// the file is removed while it is locked, so that no other process locks it before it is removed
+	unlink(path.c_str());
+	close(fd);
+}
+
+int PidFileLock::getFd() const {
+	return fd;
+}
+
+}
+}
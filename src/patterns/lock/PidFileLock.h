@@ -0,0 +1,59 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef PIDFILELOCK_H_
+#define PIDFILELOCK_H_
+
+#include <memory>
+#include <string>
+
+#include <sys/types.h>
+
+namespace msc42 {
+namespace patterns {
+
+// lock of a single running instance by an exclusive flock of a file with the process id of the owner,
+// the kernel releases the lock when the owner terminates in any way (also by SIGKILL or a crash),
+// so a stale lock never blocks the start of a new instance
+class PidFileLock {
+public:
+	// returns an empty pointer if the file cannot be opened (ownerPid is 0) or if another process holds the lock
+	// (ownerPid is its process id), on success ownerPid is the process id of a previous owner, which terminated
+	// without removing the file, or 0
+	static std::unique_ptr<PidFileLock> tryLock(const std::string &path, pid_t &ownerPid);
+
+	// removes the file and releases the lock
+	virtual ~PidFileLock();
+
+	PidFileLock(const PidFileLock &) = delete;
+	PidFileLock &operator=(const PidFileLock &) = delete;
+
+	// a forked process must close the file descriptor, otherwise it keeps the lock after the owner terminated
+	int getFd() const;
+
+private:
+	PidFileLock(int fd, const std::string &path);
+
+	const int fd;
+	const std::string path;
+};
+
+}
+}
+
+#endif /* PIDFILELOCK_H_ */
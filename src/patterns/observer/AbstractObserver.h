@@ -20,6 +20,8 @@
 
 #include <string>
 
+#include "Event.h"
+
 namespace msc42 {
 namespace patterns {
 
@@ -30,6 +32,7 @@ public:
 	AbstractObserver();
 	virtual ~AbstractObserver();
 	virtual bool notify(int messageId, const std::string &message1 = "", const std::string &message2 = "") = 0;
+	virtual bool notify(const Event &event) = 0;
 };
 
 }
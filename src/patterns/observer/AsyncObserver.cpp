@@ -0,0 +1,112 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "AsyncObserver.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AbstractObserver.h"
+#include "Event.h"
+
+namespace msc42 {
+namespace patterns {
+
+// the dispatcher checks the queue at least in this interval, even if a wake up is missed
+const std::chrono::milliseconds MAX_DISPATCH_DELAY(100);
+
+AsyncObserver::AsyncObserver(const std::vector<std::shared_ptr<AbstractObserver>> &observers, std::size_t capacity,
+		std::size_t textCapacity)
+: observers(observers), queue(capacity), textQueue(textCapacity), droppedCount(0), stopFlag(false) {
+	dispatcher = std::thread(&AsyncObserver::dispatch, this);
+}
+
+AsyncObserver::~AsyncObserver() {
+	stopFlag = true;
+	condition.notify_one();
+	dispatcher.join();
+}
+
+bool AsyncObserver::notify(int messageId, const std::string &message1, const std::string &message2) {
+	// the strings are copied by the notifying thread, the observers (e.g. a flush of the log) run in the dispatcher
+	if (!textQueue.tryPush({messageId, message1, message2})) {
+		droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	condition.notify_one();
+	return true;
+}
+
+bool AsyncObserver::notify(const Event &event) {
+	if (!queue.tryPush(event)) {
+		droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// does not block, the dispatcher waits without holding the mutex
+	condition.notify_one();
+	return true;
+}
+
+std::size_t AsyncObserver::getQueueDepth() const {
+	return queue.size() + textQueue.size();
+}
+
+unsigned long AsyncObserver::getDroppedCount() const {
+	return droppedCount.load(std::memory_order_relaxed);
+}
+
+void AsyncObserver::dispatch() {
+	Event current;
+	TextNotification currentText;
+
+	for (;;) {
+		// the flag is read before the queues are drained, so that the last notifications of the devices,
+		// which are queued before the flag is set, are delivered
+		bool isStopping = stopFlag;
+
+		// the text notifications are rare messages of the configuration and the reports, they are delivered first
+		while (textQueue.tryPop(currentText)) {
+			for (const std::shared_ptr<AbstractObserver> &observer : observers) {
+				observer->notify(currentText.messageId, currentText.message1, currentText.message2);
+			}
+		}
+
+		while (queue.tryPop(current)) {
+			for (const std::shared_ptr<AbstractObserver> &observer : observers) {
+				observer->notify(current);
+			}
+		}
+
+		if (isStopping) {
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait_for(lock, MAX_DISPATCH_DELAY,
+				[this] { return stopFlag || queue.size() > 0 || textQueue.size() > 0; });
+	}
+}
+
+}
+}
@@ -0,0 +1,77 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ASYNCOBSERVER_H_
+#define ASYNCOBSERVER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AbstractObserver.h"
+#include "Event.h"
+#include "patterns/queue/BoundedMpscQueue.h"
+
+namespace msc42 {
+namespace patterns {
+
+// observer which queues the events and forwards them to its observers in a dispatcher thread,
+// so that slow observers do not block the notifying thread, notifications of a full queue are dropped,
+// the rare notifications with text messages have their own smaller queue, because their strings are allocated
+class AsyncObserver : public AbstractObserver {
+public:
+	AsyncObserver(const std::vector<std::shared_ptr<AbstractObserver>> &observers, std::size_t capacity,
+			std::size_t textCapacity = DEFAULT_TEXT_CAPACITY);
+	virtual ~AsyncObserver();
+
+	virtual bool notify(int messageId, const std::string &message1 = "", const std::string &message2 = "");
+	virtual bool notify(const Event &event);
+
+	std::size_t getQueueDepth() const;
+	unsigned long getDroppedCount() const;
+
+private:
+	static const std::size_t DEFAULT_TEXT_CAPACITY = 64;
+
+	struct TextNotification {
+		int messageId;
+		std::string message1;
+		std::string message2;
+	};
+
+	const std::vector<std::shared_ptr<AbstractObserver>> observers;
+	BoundedMpscQueue<Event> queue;
+	BoundedMpscQueue<TextNotification> textQueue;
+	std::atomic<unsigned long> droppedCount;
+
+	std::atomic<bool> stopFlag;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::thread dispatcher;
+
+	void dispatch();
+};
+
+}
+}
+
+#endif /* ASYNCOBSERVER_H_ */
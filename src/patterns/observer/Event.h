@@ -0,0 +1,48 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef EVENT_H_
+#define EVENT_H_
+
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+
+namespace msc42 {
+namespace patterns {
+
+// compact notification, which is copied without heap allocations,
+// observers format it only if they really emit a message
+struct Event {
+	static const std::size_t MAX_SOURCE_TYPE_LENGTH = 15;
+
+	int messageId;
+	char sourceType[MAX_SOURCE_TYPE_LENGTH + 1];
+	int sourceId;
+	// position of the source in the configuration, so that observers can use flat tables
+	int sourceIndex;
+	int temperature;
+	int fanSpeed;
+	std::chrono::steady_clock::time_point timestamp;
+};
+
+static_assert(std::is_trivially_copyable<Event>::value, "Event must be copyable without allocations");
+
+}
+}
+
+#endif /* EVENT_H_ */
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "AbstractObserver.h"
+#include "Event.h"
 
 namespace msc42 {
 namespace patterns {
@@ -41,6 +42,12 @@ void Observable::notifyObservers(int messageId, const std::string &message1, con
 	}
 }
 
+void Observable::notifyObservers(const Event &event) const {
+	for (const std::shared_ptr<AbstractObserver> &observer : observers) {
+		observer->notify(event);
+	}
+}
+
 }
 }
 
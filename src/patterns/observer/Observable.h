@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "AbstractObserver.h"
+#include "Event.h"
 
 namespace msc42 {
 namespace patterns {
@@ -34,6 +35,7 @@ public:
 
 	virtual void registerObserver(std::shared_ptr<AbstractObserver> observer);
 	virtual void notifyObservers(int messageId, const std::string &message1 = "", const std::string &message2 = "") const;
+	virtual void notifyObservers(const Event &event) const;
 
 private:
 	std::vector<std::shared_ptr<AbstractObserver>> observers;
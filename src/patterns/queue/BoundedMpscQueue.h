@@ -0,0 +1,122 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOUNDEDMPSCQUEUE_H_
+#define BOUNDEDMPSCQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace msc42 {
+namespace patterns {
+
+// lock free bounded queue for multiple producers and a single consumer,
+// every slot has a sequence number which tells producers and the consumer whether the slot is free or filled
+template <typename T> class BoundedMpscQueue {
+public:
+	// the capacity is rounded up to a power of two
+	BoundedMpscQueue(std::size_t capacity)
+	: mask(roundUpToPowerOfTwo(capacity) - 1), slots(new slot[mask + 1]), enqueuePosition(0), dequeuePosition(0) {
+		for (std::size_t i = 0; i <= mask; ++i) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	BoundedMpscQueue(const BoundedMpscQueue &) = delete;
+	BoundedMpscQueue &operator=(const BoundedMpscQueue &) = delete;
+
+	// returns false without blocking if the queue is full
+	bool tryPush(T value) {
+		std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+		slot *target;
+
+		for (;;) {
+			target = &slots[position & mask];
+			std::size_t sequence = target->sequence.load(std::memory_order_acquire);
+			std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+			if (difference == 0) {
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		target->value = std::move(value);
+		target->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// must only be called by the single consumer
+	bool tryPop(T &value) {
+		std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+		slot &source = slots[position & mask];
+		std::size_t sequence = source.sequence.load(std::memory_order_acquire);
+
+		if (sequence != position + 1) {
+			return false;
+		}
+
+		value = std::move(source.value);
+		source.sequence.store(position + mask + 1, std::memory_order_release);
+		dequeuePosition.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	std::size_t size() const {
+		std::size_t dequeued = dequeuePosition.load(std::memory_order_acquire);
+		std::size_t enqueued = enqueuePosition.load(std::memory_order_acquire);
+		return enqueued > dequeued ? enqueued - dequeued : 0;
+	}
+
+	std::size_t capacity() const {
+		return mask + 1;
+	}
+
+private:
+	struct slot {
+		std::atomic<std::size_t> sequence;
+		T value;
+	};
+
+	static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+		std::size_t powerOfTwo = 1;
+		while (powerOfTwo < value) {
+			powerOfTwo <<= 1;
+		}
+		return powerOfTwo;
+	}
+
+	const std::size_t mask;
+	const std::unique_ptr<slot[]> slots;
+
+	// producers and the consumer write different cache lines
+	alignas(64) std::atomic<std::size_t> enqueuePosition;
+	alignas(64) std::atomic<std::size_t> dequeuePosition;
+};
+
+}
+}
+
+#endif /* BOUNDEDMPSCQUEUE_H_ */
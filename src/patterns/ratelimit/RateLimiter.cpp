@@ -0,0 +1,68 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#include "RateLimiter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+namespace msc42 {
+namespace patterns {
+
+RateLimiter::RateLimiter(std::size_t sources, std::size_t messages, const std::chrono::milliseconds &interval,
+		unsigned int burst)
+: messages(messages), interval(interval), capacity(interval * std::max(burst, 1u)),
+  buckets(sources * messages, bucket()) {
+}
+
+void RateLimiter::setSourceCount(std::size_t sources) {
+	buckets.assign(sources * messages, bucket());
+}
+
+bool RateLimiter::tryAcquire(std::size_t source, std::size_t messageId,
+		const std::chrono::steady_clock::time_point &now, unsigned int &suppressed) {
+	suppressed = 0;
+
+	if (messageId >= messages || source >= buckets.size() / messages || interval.count() <= 0) {
+		return true;
+	}
+
+	bucket &entry = buckets[source * messages + messageId];
+
+	// a bucket is full before its first event
+	if (!entry.used) {
+		entry.used = true;
+		entry.credit = capacity;
+	} else if (now > entry.lastRefill) {
+		entry.credit = std::min(capacity, entry.credit + (now - entry.lastRefill));
+	}
+	entry.lastRefill = std::max(entry.lastRefill, now);
+
+	if (entry.credit < interval) {
+		++entry.suppressed;
+		return false;
+	}
+
+	entry.credit -= interval;
+	suppressed = entry.suppressed;
+	entry.suppressed = 0;
+	return true;
+}
+
+}
+}
@@ -0,0 +1,63 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef RATELIMITER_H_
+#define RATELIMITER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace msc42 {
+namespace patterns {
+
+// token bucket for every pair of source and message id, stored in a flat table,
+// a bucket holds up to burst tokens and gets one token per interval,
+// the class is not thread safe, the owner must synchronize the calls
+class RateLimiter {
+public:
+	RateLimiter(std::size_t sources, std::size_t messages, const std::chrono::milliseconds &interval,
+			unsigned int burst = 1);
+
+	// the table is resized and all buckets are full again
+	void setSourceCount(std::size_t sources);
+
+	// returns true if the event can be emitted, suppressed is set to the number of events
+	// which are suppressed since the last emitted event of the same source and message id,
+	// sources and message ids out of the table are never limited
+	bool tryAcquire(std::size_t source, std::size_t messageId, const std::chrono::steady_clock::time_point &now,
+			unsigned int &suppressed);
+
+private:
+	struct bucket {
+		// a token is worth one interval, so that no floating point arithmetic is needed
+		std::chrono::steady_clock::duration credit;
+		std::chrono::steady_clock::time_point lastRefill;
+		unsigned int suppressed;
+		bool used;
+	};
+
+	const std::size_t messages;
+	const std::chrono::steady_clock::duration interval;
+	const std::chrono::steady_clock::duration capacity;
+	std::vector<bucket> buckets;
+};
+
+}
+}
+
+#endif /* RATELIMITER_H_ */
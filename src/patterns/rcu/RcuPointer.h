@@ -0,0 +1,114 @@
+// Copyright (C) 2017 Stefan Constantin
+//
+// This file is part of fanspeedcontrol.
+//
+// fanspeedcontrol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fanspeedcontrol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fanspeedcontrol. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef RCUPOINTER_H_
+#define RCUPOINTER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace msc42 {
+namespace patterns {
+
+// pointer to an immutable value, which is read wait-free by a single reader thread and replaced by writers
+// (read copy update), a replaced value is deleted by a later writer after the reader has announced
+// a quiescent state, in which it holds no reference to a value (quiescent state based reclamation)
+template <typename T> class RcuPointer {
+public:
+	RcuPointer(std::unique_ptr<const T> value)
+	: current(value.release()), readerEpoch(0) {
+	}
+
+	RcuPointer(const RcuPointer &) = delete;
+	RcuPointer &operator=(const RcuPointer &) = delete;
+
+	virtual ~RcuPointer() {
+		delete current.load(std::memory_order_relaxed);
+	}
+
+	// reader, the value stays valid until the next call of quiescent
+	const T &read() const {
+		return *current.load(std::memory_order_seq_cst);
+	}
+
+	// reader, announces that the reader holds no reference returned by read, e.g. between two iterations
+	void quiescent() {
+		readerEpoch.store(readerEpoch.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+	}
+
+	// any thread except the reader, a copy of the newest value
+	T copy() const {
+		std::lock_guard<std::mutex> lock(writerMutex);
+		return *current.load(std::memory_order_relaxed);
+	}
+
+	// writer, replaces the value by a changed copy of the newest value, unless update returns false
+	template <typename Update> bool update(Update update) {
+		std::lock_guard<std::mutex> lock(writerMutex);
+		std::unique_ptr<T> copy(new T(*current.load(std::memory_order_relaxed)));
+		if (!update(*copy)) {
+			return false;
+		}
+
+		replace(std::move(copy));
+		return true;
+	}
+
+	// writer
+	void publish(std::unique_ptr<const T> value) {
+		std::lock_guard<std::mutex> lock(writerMutex);
+		replace(std::move(value));
+	}
+
+private:
+	struct retiredValue {
+		std::unique_ptr<const T> value;
+		unsigned long epoch;
+	};
+
+	std::atomic<const T *> current;
+	std::atomic<unsigned long> readerEpoch;
+
+	mutable std::mutex writerMutex;
+	std::vector<retiredValue> retired;
+
+	void replace(std::unique_ptr<const T> value) {
+		// the sequentially consistent exchange and load of the epoch guarantee, that a reader, which announces
+		// a quiescent state after the epoch was loaded, reads the new value afterwards
+		std::unique_ptr<const T> old(current.exchange(value.release(), std::memory_order_seq_cst));
+		unsigned long epoch = readerEpoch.load(std::memory_order_seq_cst);
+		retired.push_back({std::move(old), epoch});
+
+		// values retired before the last quiescent state of the reader are not referenced anymore
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < retired.size(); ++i) {
+			if (retired[i].epoch >= epoch) {
+				retired[kept++] = std::move(retired[i]);
+			}
+		}
+		retired.resize(kept);
+	}
+};
+
+}
+}
+
+#endif /* RCUPOINTER_H_ */